@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui network sql
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -12,25 +12,79 @@ INCLUDEPATH += src
 
 SOURCES += \
     src/backup/backupmanager.cpp \
+    src/logging/logarchive.cpp \
+    src/logging/logarchivewriter.cpp \
+    src/logging/logindex.cpp \
+    src/logging/logstore.cpp \
     src/server/bedrockserver.cpp \
+    src/server/commandqueue.cpp \
+    src/server/lifecycletimeline.cpp \
+    src/server/responseparser.cpp \
+    src/server/outputthrottle.cpp \
+    src/server/playermappings.cpp \
+    src/server/playerregistry.cpp \
+    src/server/responsivenessprobe.cpp \
+    src/server/serverconfigstore.cpp \
+    src/telemetry/metricsexporter.cpp \
+    src/telemetry/metricshistory.cpp \
+    src/telemetry/processtelemetry.cpp \
+    src/telemetry/telemetryseries.cpp \
+    src/telemetry/timeseriesblock.cpp \
+    src/telemetry/timeseriesstore.cpp \
     src/main.cpp \
     src/mainwindow.cpp \
+    src/players/sessionstore.cpp \
     src/server/bedrockservermodel.cpp \
     src/widgets/onlineplayerwidget.cpp \
     src/widgets/playerinfowidget.cpp \
+    src/widgets/playerfiltermodel.cpp \
+    src/widgets/serverpropertiesmodel.cpp \
+    src/widgets/consolelogmodel.cpp \
+    src/widgets/consolelinedelegate.cpp \
+    src/widgets/loghistorydialog.cpp \
+    src/widgets/sparklinewidget.cpp \
+    src/widgets/historychartwidget.cpp \
     src/widgets/serverconsolewidget.cpp
 
 HEADERS += \
     src/backup/backupmanager.h \
+    src/logging/logarchive.h \
+    src/logging/logarchivewriter.h \
+    src/logging/logindex.h \
+    src/logging/logstore.h \
+    src/logging/logrecord.h \
     src/server/bedrockserver.h \
+    src/server/commandqueue.h \
+    src/server/lifecycletimeline.h \
+    src/server/responseparser.h \
+    src/server/outputthrottle.h \
+    src/server/playermappings.h \
+    src/server/playerregistry.h \
+    src/server/responsivenessprobe.h \
+    src/server/serverconfigstore.h \
+    src/telemetry/metricsexporter.h \
+    src/telemetry/metricshistory.h \
+    src/telemetry/processtelemetry.h \
+    src/telemetry/telemetryseries.h \
+    src/telemetry/timeseriesblock.h \
+    src/telemetry/timeseriesstore.h \
     src/mainwindow.h \
+    src/players/sessionstore.h \
     src/server/bedrockservermodel.h \
     src/widgets/onlineplayerwidget.h \
     src/widgets/playerinfowidget.h \
+    src/widgets/playerfiltermodel.h \
+    src/widgets/serverpropertiesmodel.h \
+    src/widgets/consolelogmodel.h \
+    src/widgets/consolelinedelegate.h \
+    src/widgets/loghistorydialog.h \
+    src/widgets/sparklinewidget.h \
+    src/widgets/historychartwidget.h \
     src/widgets/serverconsolewidget.h
 
 FORMS += \
     src/mainwindow.ui \
+    src/widgets/loghistorydialog.ui \
     src/widgets/playerinfowidget.ui \
     src/widgets/serverconsolewidget.ui
 
@@ -0,0 +1,261 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "logarchive.h"
+#include "logarchivewriter.h"
+#include <QSettings>
+#include <QStandardPaths>
+#include <QDataStream>
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+#define LOG_HANDOFF_MS 250
+#define LOG_MIN_RECORD_BYTES 13 // Time, type and an empty text's length
+
+LogArchive::LogArchive(BedrockServer *server, QObject *parent) : QObject(parent), server(server), nextRequest(0)
+{
+    qRegisterMetaType<LogRecord>("LogRecord");
+    qRegisterMetaType<QList<LogRecord>>("QList<LogRecord>");
+
+    this->enabled = getEnabled();
+
+    this->writer = new LogArchiveWriter(getLogFolder(),getRetentionDays(),getMaximumSizeMiB()*1024LL*1024LL);
+    this->writer->moveToThread(&this->writerThread);
+    connect(&this->writerThread,&QThread::started,this->writer,&LogArchiveWriter::start);
+    connect(this,&LogArchive::writeRecords,this->writer,&LogArchiveWriter::writeRecords);
+    connect(this,&LogArchive::retentionChanged,this->writer,&LogArchiveWriter::setRetention);
+    connect(this,&LogArchive::readRequested,this->writer,&LogArchiveWriter::readRange);
+    connect(this,&LogArchive::exportRequested,this->writer,&LogArchiveWriter::exportRange);
+    connect(this->writer,&LogArchiveWriter::rangeRead,this,&LogArchive::rangeRead);
+    connect(this->writer,&LogArchiveWriter::rangeExported,this,&LogArchive::rangeExported);
+    this->writerThread.setObjectName("LogArchiveWriter");
+    this->writerThread.start(QThread::LowPriority);
+
+    this->pendingTimer.setSingleShot(true);
+    this->pendingTimer.setInterval(LOG_HANDOFF_MS);
+    connect(&this->pendingTimer,&QTimer::timeout,this,&LogArchive::handOver);
+
+    // Server lines come through serverLogLine so flood throttled lines are kept too,
+    // everything else the console prints comes through serverOutput.
+    connect(this->server,&BedrockServer::serverLogLine,this,&LogArchive::append);
+    connect(this->server,&BedrockServer::serverOutput,this,[=](BedrockServer::OutputType type, QString line) {
+        if (type!=BedrockServer::ServerInfoOutput) {
+            this->append(type,line);
+        }
+    });
+}
+
+LogArchive::~LogArchive()
+{
+    flush();
+    QMetaObject::invokeMethod(this->writer,&LogArchiveWriter::close,Qt::BlockingQueuedConnection);
+    this->writerThread.quit();
+    this->writerThread.wait();
+    delete this->writer;
+}
+
+QString LogArchive::getLogFolder()
+{
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("logs");
+}
+
+bool LogArchive::getEnabled()
+{
+    return QSettings().value("logging/enabled",true).toBool();
+}
+
+int LogArchive::getRetentionDays()
+{
+    return QSettings().value("logging/retentionDays",28).toInt();
+}
+
+int LogArchive::getMaximumSizeMiB()
+{
+    return QSettings().value("logging/maximumSizeMiB",1024).toInt();
+}
+
+qint64 LogArchive::getArchiveSize()
+{
+    qint64 size = 0;
+    QDir dir(getLogFolder());
+    for(const QFileInfo &info : dir.entryInfoList(QDir::Files)) {
+        size += info.size();
+    }
+    return size;
+}
+
+QDateTime LogArchive::getOldestTime()
+{
+    QList<qint64> starts = getSegmentStarts(getLogFolder());
+    return starts.isEmpty() ? QDateTime() : QDateTime::fromMSecsSinceEpoch(starts.first());
+}
+
+int LogArchive::readRange(QDateTime from, QDateTime to, int maxLines)
+{
+    handOver();
+    int request = this->nextRequest++;
+    emit readRequested(request,from.toMSecsSinceEpoch(),to.toMSecsSinceEpoch(),maxLines);
+    return request;
+}
+
+int LogArchive::exportRange(QDateTime from, QDateTime to, QString fileName)
+{
+    handOver();
+    int request = this->nextRequest++;
+    emit exportRequested(request,from.toMSecsSinceEpoch(),to.toMSecsSinceEpoch(),fileName);
+    return request;
+}
+
+void LogArchive::append(BedrockServer::OutputType type, QString text)
+{
+    if (!this->enabled) {
+        return;
+    }
+    LogRecord record;
+    record.time = QDateTime::currentMSecsSinceEpoch();
+    record.type = type;
+    record.text = text;
+    this->pending.append(record);
+    if (!this->pendingTimer.isActive()) {
+        this->pendingTimer.start();
+    }
+}
+
+void LogArchive::setEnabled(bool state)
+{
+    QSettings().setValue("logging/enabled",state);
+    this->enabled = state;
+    if (!state) {
+        flush();
+    }
+}
+
+void LogArchive::setRetentionDays(int days)
+{
+    QSettings().setValue("logging/retentionDays",days);
+    emit retentionChanged(days,getMaximumSizeMiB()*1024LL*1024LL);
+}
+
+void LogArchive::setMaximumSizeMiB(int mib)
+{
+    QSettings().setValue("logging/maximumSizeMiB",mib);
+    emit retentionChanged(getRetentionDays(),mib*1024LL*1024LL);
+}
+
+void LogArchive::handOver()
+{
+    this->pendingTimer.stop();
+    if (!this->pending.isEmpty()) {
+        emit writeRecords(this->pending);
+        this->pending.clear();
+    }
+}
+
+void LogArchive::flush()
+{
+    handOver();
+    // Queued behind the records above, so once this returns they're in the files.
+    QMetaObject::invokeMethod(this->writer,&LogArchiveWriter::flushBlock,Qt::BlockingQueuedConnection);
+}
+
+QList<qint64> LogArchive::getSegmentStarts(QString folder)
+{
+    QList<qint64> ret;
+    QDir dir(folder);
+    for(const QString &name : dir.entryList(QStringList() << QString("*")+LOG_SEGMENT_SUFFIX,QDir::Files)) {
+        bool ok = false;
+        qint64 start = name.section('.',0,0).toLongLong(&ok);
+        if (ok) {
+            ret.append(start);
+        }
+    }
+    std::sort(ret.begin(),ret.end());
+    return ret;
+}
+
+void LogArchive::readRecords(QString folder, qint64 from, qint64 to, std::function<bool(const LogRecord&)> handler)
+{
+    QDir dir(folder);
+    QList<qint64> starts = getSegmentStarts(dir.path());
+    for(int x=0;x<starts.size();x++) {
+        // A segment runs until the next one starts, skip any that can't overlap without opening them.
+        qint64 start = starts.at(x);
+        qint64 end = (x+1<starts.size()) ? starts.at(x+1) : std::numeric_limits<qint64>::max();
+        if (start>to || end<from) {
+            continue;
+        }
+
+        QFile index(dir.filePath(QString::number(start)+LOG_INDEX_SUFFIX));
+        QFile segment(dir.filePath(QString::number(start)+LOG_SEGMENT_SUFFIX));
+        if (!index.open(QIODevice::ReadOnly) || !segment.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        QDataStream indexIn(&index);
+        while(!indexIn.atEnd()) {
+            qint64 first,last,offset;
+            quint32 lines;
+            indexIn >> first >> last >> offset >> lines;
+            if (indexIn.status()!=QDataStream::Ok) {
+                break;
+            }
+            if (last<from || first>to) {
+                continue;
+            }
+
+            QList<LogRecord> records;
+            if (!readBlock(&segment,offset,records)) {
+                continue;
+            }
+            for(const LogRecord &record : records) {
+                if (record.time<from || record.time>to) {
+                    continue;
+                }
+                if (!handler(record)) {
+                    return;
+                }
+            }
+        }
+    }
+}
+
+bool LogArchive::readBlock(QIODevice *segment, qint64 offset, QList<LogRecord> &records)
+{
+    quint32 magic;
+    qint64 first,last;
+    quint32 lines;
+    QByteArray compressed;
+    QDataStream segmentIn(segment);
+    segment->seek(offset);
+    segmentIn >> magic >> first >> last >> lines >> compressed;
+    if (segmentIn.status()!=QDataStream::Ok || magic!=LOG_BLOCK_MAGIC) {
+        qDebug()<<"Bad log block at"<<offset;
+        return false;
+    }
+
+    QByteArray block = qUncompress(compressed);
+    QDataStream blockIn(block);
+    // The count comes off the disk, so it's only trusted as far as the block could hold.
+    records.reserve(records.size()+qMin((qint64)lines,(qint64)block.size()/LOG_MIN_RECORD_BYTES));
+    for(quint32 line=0;line<lines && !blockIn.atEnd();line++) {
+        LogRecord record;
+        qint8 type;
+        QByteArray text;
+        blockIn >> record.time >> type >> text;
+        record.type = (BedrockServer::OutputType)type;
+        record.text = QString::fromUtf8(text);
+        records.append(record);
+    }
+    return blockIn.status()==QDataStream::Ok;
+}
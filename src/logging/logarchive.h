@@ -0,0 +1,78 @@
+#ifndef LOGARCHIVE_H
+#define LOGARCHIVE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QDateTime>
+#include <functional>
+#include <server/bedrockserver.h>
+#include "logrecord.h"
+
+class LogArchiveWriter;
+
+// Keeps every line of server output in compressed, rotating segments on disk. Writing
+// happens on a worker thread, lines are handed over in batches so the output path never
+// waits on the disk.
+class LogArchive : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogArchive(BedrockServer *server, QObject *parent = nullptr);
+    ~LogArchive();
+
+    QString getLogFolder();
+    bool getEnabled();
+    int getRetentionDays();
+    int getMaximumSizeMiB();
+    qint64 getArchiveSize();
+    QDateTime getOldestTime();
+
+    // Both are read on the writer thread and answered by a signal carrying the returned request.
+    int readRange(QDateTime from, QDateTime to, int maxLines = 100000);
+    int exportRange(QDateTime from, QDateTime to, QString fileName);
+
+    static QList<qint64> getSegmentStarts(QString folder); // Sorted, oldest first
+    static bool readBlock(QIODevice *segment, qint64 offset, QList<LogRecord> &records); // Appends the block's lines to records.
+    static void readRecords(QString folder, qint64 from, qint64 to, std::function<bool(const LogRecord&)> handler); // Until handler returns false
+
+public slots:
+    void append(BedrockServer::OutputType type, QString text);
+    void setEnabled(bool state);
+    void setRetentionDays(int days);
+    void setMaximumSizeMiB(int mib);
+    void flush(); // Returns once everything appended so far is on disk.
+
+signals:
+    void writeRecords(QList<LogRecord> records);
+    void retentionChanged(int days, qint64 maxBytes);
+    void readRequested(int request, qint64 from, qint64 to, int maxLines);
+    void exportRequested(int request, qint64 from, qint64 to, QString fileName);
+    void rangeRead(int request, QList<LogRecord> records);
+    void rangeExported(int request, qint64 lines); // Lines written, or -1 on error
+
+private:
+    BedrockServer *server;
+    QThread writerThread;
+    LogArchiveWriter *writer;
+    QList<LogRecord> pending;
+    QTimer pendingTimer;
+    bool enabled;
+    int nextRequest;
+
+    void handOver();
+};
+
+#endif // LOGARCHIVE_H
@@ -0,0 +1,188 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "logarchivewriter.h"
+#include "logarchive.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDebug>
+
+#define LOG_BLOCK_BYTES (64*1024)
+#define LOG_BLOCK_LINES 2048
+#define LOG_BLOCK_IDLE_MS 5000 // Partly filled blocks are written after this long without output
+#define LOG_SEGMENT_BYTES (8*1024*1024)
+#define LOG_SEGMENT_MS (24*60*60*1000LL)
+
+LogArchiveWriter::LogArchiveWriter(QString folder, int retentionDays, qint64 maxBytes)
+    : QObject(nullptr),folder(folder),retentionDays(retentionDays),maxBytes(maxBytes),segmentStart(0),blockFirst(0),blockLast(0),blockLines(0),idleTimer(nullptr)
+{
+}
+
+void LogArchiveWriter::start()
+{
+    // Created here so the timer belongs to the writer thread.
+    this->idleTimer = new QTimer(this);
+    this->idleTimer->setSingleShot(true);
+    this->idleTimer->setInterval(LOG_BLOCK_IDLE_MS);
+    connect(this->idleTimer,&QTimer::timeout,this,&LogArchiveWriter::flushBlock);
+
+    QDir().mkpath(this->folder);
+    pruneSegments();
+}
+
+void LogArchiveWriter::writeRecords(QList<LogRecord> records)
+{
+    for(const LogRecord &record : records) {
+        if (!this->segment.isOpen() ||
+                this->segment.size()>=LOG_SEGMENT_BYTES ||
+                record.time-this->segmentStart>=LOG_SEGMENT_MS) {
+            flushBlock();
+            openSegment(record.time);
+            if (!this->segment.isOpen()) {
+                continue;
+            }
+        }
+        if (this->blockLines==0) {
+            this->blockFirst = record.time;
+        }
+        this->blockLast = record.time;
+        this->blockLines++;
+
+        QDataStream out(&this->block,QIODevice::WriteOnly|QIODevice::Append);
+        out << record.time << (qint8)record.type << record.text.toUtf8();
+
+        if (this->block.size()>=LOG_BLOCK_BYTES || this->blockLines>=LOG_BLOCK_LINES) {
+            flushBlock();
+        }
+    }
+    if (this->blockLines>0) {
+        this->idleTimer->start();
+    }
+}
+
+void LogArchiveWriter::flushBlock()
+{
+    if (this->blockLines==0 || !this->segment.isOpen()) {
+        return;
+    }
+    qint64 offset = this->segment.size();
+    QDataStream out(&this->segment);
+    out << (quint32)LOG_BLOCK_MAGIC << this->blockFirst << this->blockLast << this->blockLines << qCompress(this->block);
+    this->segment.flush();
+
+    // The index entry only goes out once the block is on disk, so readers never see half a block.
+    QDataStream indexOut(&this->index);
+    indexOut << this->blockFirst << this->blockLast << offset << this->blockLines;
+    this->index.flush();
+
+    this->block.clear();
+    this->blockLines = 0;
+    if (this->idleTimer) {
+        this->idleTimer->stop();
+    }
+}
+
+void LogArchiveWriter::close()
+{
+    flushBlock();
+    this->segment.close();
+    this->index.close();
+}
+
+void LogArchiveWriter::setRetention(int days, qint64 maxBytes)
+{
+    this->retentionDays = days;
+    this->maxBytes = maxBytes;
+    pruneSegments();
+}
+
+void LogArchiveWriter::readRange(int request, qint64 from, qint64 to, int maxLines)
+{
+    // Anything handed over before the request is in the files once the open block is written.
+    flushBlock();
+    QList<LogRecord> records;
+    LogArchive::readRecords(this->folder,from,to,[&](const LogRecord &record) {
+        records.append(record);
+        return records.size()<maxLines;
+    });
+    emit rangeRead(request,records);
+}
+
+void LogArchiveWriter::exportRange(int request, qint64 from, qint64 to, QString fileName)
+{
+    // New lines wait in the queue while a long range is exported, nothing is lost.
+    flushBlock();
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly|QIODevice::Truncate)) {
+        emit rangeExported(request,-1);
+        return;
+    }
+    qint64 lines = 0;
+    LogArchive::readRecords(this->folder,from,to,[&](const LogRecord &record) {
+        file.write(QDateTime::fromMSecsSinceEpoch(record.time).toString("yyyy-MM-dd hh:mm:ss.zzz").toUtf8());
+        file.write("  ");
+        file.write(record.text.toUtf8());
+        file.write("\n");
+        lines++;
+        return true;
+    });
+    emit rangeExported(request,file.error()==QFileDevice::NoError ? lines : -1);
+}
+
+void LogArchiveWriter::openSegment(qint64 time)
+{
+    this->segment.close();
+    this->index.close();
+
+    this->segmentStart = time;
+    QDir dir(this->folder);
+    this->segment.setFileName(dir.filePath(QString::number(time)+LOG_SEGMENT_SUFFIX));
+    this->index.setFileName(dir.filePath(QString::number(time)+LOG_INDEX_SUFFIX));
+    if (!this->segment.open(QIODevice::WriteOnly|QIODevice::Append) || !this->index.open(QIODevice::WriteOnly|QIODevice::Append)) {
+        qDebug()<<"Unable to open log segment"<<this->segment.fileName();
+        this->segment.close();
+        this->index.close();
+    }
+    pruneSegments();
+}
+
+void LogArchiveWriter::pruneSegments()
+{
+    QDir dir(this->folder);
+    QStringList segments = dir.entryList(QStringList() << QString("*")+LOG_SEGMENT_SUFFIX,QDir::Files,QDir::Name);
+    QString current = QFileInfo(this->segment.fileName()).fileName();
+    qint64 oldest = QDateTime::currentMSecsSinceEpoch() - this->retentionDays*24*60*60*1000LL;
+
+    qint64 total = 0;
+    for(const QString &name : segments) {
+        total += QFileInfo(dir.filePath(name)).size();
+    }
+
+    // Oldest first, a segment goes once the one after it starts before the cut off or we're over size.
+    for(int x=0;x<segments.size();x++) {
+        QString name = segments.at(x);
+        if (name==current) {
+            break;
+        }
+        qint64 end = (x+1<segments.size()) ? segments.at(x+1).section('.',0,0).toLongLong() : QDateTime::currentMSecsSinceEpoch();
+        bool expired = this->retentionDays>0 && end<oldest;
+        bool oversize = this->maxBytes>0 && total>this->maxBytes;
+        if (!expired && !oversize) {
+            break;
+        }
+        total -= QFileInfo(dir.filePath(name)).size();
+        dir.remove(name);
+        dir.remove(name.section('.',0,0)+LOG_INDEX_SUFFIX);
+        qDebug()<<"Pruned log segment"<<name;
+    }
+}
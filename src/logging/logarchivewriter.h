@@ -0,0 +1,66 @@
+#ifndef LOGARCHIVEWRITER_H
+#define LOGARCHIVEWRITER_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include "logrecord.h"
+
+// On disk a segment is <start ms>.mclog, a run of qCompress'd blocks each with a small
+// header, alongside <start ms>.mcidx which holds one fixed size entry per block. The
+// index is all a reader needs to find the blocks covering a time range.
+#define LOG_SEGMENT_SUFFIX ".mclog"
+#define LOG_INDEX_SUFFIX ".mcidx"
+#define LOG_BLOCK_MAGIC 0x4d434c42 // MCLB
+#define LOG_INDEX_ENTRY_BYTES 28 // first, last, offset (qint64) and line count (quint32)
+
+// Lives on the archive's thread, all file IO happens here.
+class LogArchiveWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogArchiveWriter(QString folder, int retentionDays, qint64 maxBytes);
+
+public slots:
+    void start();
+    void writeRecords(QList<LogRecord> records);
+    void flushBlock();
+    void close();
+    void setRetention(int days, qint64 maxBytes);
+    void readRange(int request, qint64 from, qint64 to, int maxLines);
+    void exportRange(int request, qint64 from, qint64 to, QString fileName);
+
+signals:
+    void rangeRead(int request, QList<LogRecord> records);
+    void rangeExported(int request, qint64 lines); // -1 if the file couldn't be written
+
+private:
+    QString folder;
+    int retentionDays;
+    qint64 maxBytes;
+    QFile segment;
+    QFile index;
+    qint64 segmentStart;
+    QByteArray block; // Uncompressed records waiting to be written
+    qint64 blockFirst;
+    qint64 blockLast;
+    quint32 blockLines;
+    QTimer *idleTimer;
+
+    void openSegment(qint64 time);
+    void pruneSegments();
+};
+
+#endif // LOGARCHIVEWRITER_H
@@ -0,0 +1,324 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "logindex.h"
+#include "logarchivewriter.h"
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDir>
+#include <QSet>
+#include <QDebug>
+#include <algorithm>
+#include <iterator>
+
+#define LOG_INDEX_CATCHUP_MS 10000
+// Each segment's postings are kept in <start ms>.mcpst, a header then one record per index
+// entry holding the block's offset and its tokens. Blocks are appended as they're indexed
+// and the header is written last, anything past its length is an unfinished append.
+#define LOG_POSTINGS_SUFFIX ".mcpst"
+#define LOG_POSTINGS_MAGIC 0x4d435053 // MCPS
+#define LOG_POSTINGS_HEADER_BYTES 16 // magic, block count (quint32) and length (qint64)
+
+LogIndexWorker::LogIndexWorker(QString folder) : QObject(nullptr),folder(folder),linesIndexed(0),catchUpTimer(nullptr)
+{
+}
+
+QStringList LogIndexWorker::tokenize(const LogRecord &record)
+{
+    QStringList tokens;
+    addTokens(tokens,record.text);
+
+    // Levels come from the bedrock line, '[... ERROR]', or from the console's own messages.
+    if (record.type==BedrockServer::ErrorOutput || record.text.contains(" ERROR]")) {
+        tokens.append("level:error");
+    } else if (record.type==BedrockServer::WarningOutput || record.text.contains(" WARN]")) {
+        tokens.append("level:warn");
+    } else if (record.type==BedrockServer::InfoOutput || record.text.contains(" INFO]")) {
+        tokens.append("level:info");
+    }
+    return tokens;
+}
+
+QStringList LogIndexWorker::tokenizeQuery(QString query)
+{
+    QStringList tokens;
+    for(const QString &word : query.split(' ',Qt::SkipEmptyParts)) {
+        QString lower = word.toLower();
+        if (lower.startsWith("level:")) {
+            tokens.append(lower.startsWith("level:warn") ? QString("level:warn") : lower);
+        } else if (lower.startsWith("xuid:")) {
+            addTokens(tokens,QStringView(lower).mid(5));
+        } else {
+            addTokens(tokens,lower);
+        }
+    }
+    tokens.removeDuplicates();
+    return tokens;
+}
+
+void LogIndexWorker::addTokens(QStringList &tokens, QStringView text)
+{
+    // Runs of letters, digits and '_', lower cased. Single characters aren't worth indexing.
+    int start = -1;
+    for(int x=0;x<=text.size();x++) {
+        bool wordChar = x<text.size() && (text.at(x).isLetterOrNumber() || text.at(x)=='_');
+        if (wordChar && start<0) {
+            start = x;
+        } else if (!wordChar && start>=0) {
+            if (x-start>1) {
+                tokens.append(text.mid(start,x-start).toString().toLower());
+            }
+            start = -1;
+        }
+    }
+}
+
+void LogIndexWorker::start()
+{
+    this->catchUpTimer = new QTimer(this);
+    this->catchUpTimer->setInterval(LOG_INDEX_CATCHUP_MS);
+    connect(this->catchUpTimer,&QTimer::timeout,this,&LogIndexWorker::catchUp);
+    this->catchUpTimer->start();
+    catchUp();
+}
+
+void LogIndexWorker::catchUp()
+{
+    QElapsedTimer timer;
+    timer.start();
+    qint64 linesBefore = this->linesIndexed;
+    QDir dir(this->folder);
+    QList<qint64> starts = LogArchive::getSegmentStarts(this->folder);
+
+    // Postings go when their segment is pruned.
+    for(const QString &name : dir.entryList(QStringList() << QString("*")+LOG_POSTINGS_SUFFIX,QDir::Files)) {
+        if (!starts.contains(name.section('.',0,0).toLongLong())) {
+            dir.remove(name);
+        }
+    }
+    for(auto segment=this->segments.begin();segment!=this->segments.end();) {
+        if (starts.contains(segment.key())) {
+            ++segment;
+        } else {
+            segment = this->segments.erase(segment);
+        }
+    }
+
+    for(qint64 segmentStart : starts) {
+        if (!this->segments.contains(segmentStart)) {
+            Segment state;
+            readPostingsHeader(segmentStart,state);
+            this->segments.insert(segmentStart,state);
+        }
+        Segment &state = this->segments[segmentStart];
+        QFile index(dir.filePath(QString::number(segmentStart)+LOG_INDEX_SUFFIX));
+        if (index.size()<(state.blocksIndexed+1)*LOG_INDEX_ENTRY_BYTES) {
+            continue; // Nothing new
+        }
+        QFile segment(dir.filePath(QString::number(segmentStart)+LOG_SEGMENT_SUFFIX));
+        QFile postings(getPostingsName(segmentStart));
+        if (!index.open(QIODevice::ReadOnly) || !segment.open(QIODevice::ReadOnly) || !postings.open(QIODevice::ReadWrite)) {
+            continue;
+        }
+        index.seek(state.blocksIndexed*LOG_INDEX_ENTRY_BYTES);
+        postings.seek(state.postingsBytes);
+        QDataStream indexIn(&index);
+        QDataStream postingsOut(&postings);
+        while(index.bytesAvailable()>=LOG_INDEX_ENTRY_BYTES) {
+            qint64 first,last,offset;
+            quint32 lines;
+            indexIn >> first >> last >> offset >> lines;
+
+            // A bad block is kept with no tokens so ids stay in step with the index entries.
+            QList<LogRecord> records;
+            QSet<QString> blockTokens;
+            if (LogArchive::readBlock(&segment,offset,records)) {
+                for(const LogRecord &record : records) {
+                    for(const QString &token : tokenize(record)) {
+                        blockTokens.insert(token);
+                    }
+                }
+            }
+            QStringList tokens(blockTokens.begin(),blockTokens.end());
+            postingsOut << offset << tokens;
+            if (state.loaded) {
+                addBlock(state,offset,tokens);
+            }
+            state.blocksIndexed++;
+            this->linesIndexed += records.size();
+        }
+        state.postingsBytes = postings.pos();
+        postings.resize(state.postingsBytes);
+        postings.seek(0);
+        postingsOut << (quint32)LOG_POSTINGS_MAGIC << (quint32)state.blocksIndexed << state.postingsBytes;
+    }
+
+    if (this->linesIndexed!=linesBefore) {
+        qDebug()<<"Indexed"<<(this->linesIndexed-linesBefore)<<"log lines in"<<timer.elapsed()<<"ms over"<<this->segments.size()<<"segments";
+    }
+}
+
+QString LogIndexWorker::getPostingsName(qint64 segmentStart)
+{
+    return QDir(this->folder).filePath(QString::number(segmentStart)+LOG_POSTINGS_SUFFIX);
+}
+
+void LogIndexWorker::readPostingsHeader(qint64 segmentStart, Segment &segment)
+{
+    segment.blocksIndexed = 0;
+    segment.postingsBytes = LOG_POSTINGS_HEADER_BYTES;
+    segment.loaded = false;
+
+    QFile postings(getPostingsName(segmentStart));
+    if (!postings.open(QIODevice::ReadOnly)) {
+        return; // Not indexed yet
+    }
+    quint32 magic,blocks;
+    qint64 bytes;
+    QDataStream postingsIn(&postings);
+    postingsIn >> magic >> blocks >> bytes;
+    if (postingsIn.status()!=QDataStream::Ok || magic!=LOG_POSTINGS_MAGIC || bytes<LOG_POSTINGS_HEADER_BYTES || bytes>postings.size()) {
+        qDebug()<<"Reindexing log segment"<<segmentStart;
+        return;
+    }
+    segment.blocksIndexed = blocks;
+    segment.postingsBytes = bytes;
+}
+
+void LogIndexWorker::loadPostings(qint64 segmentStart, Segment &segment)
+{
+    segment.loaded = true;
+    QFile postings(getPostingsName(segmentStart));
+    if (!postings.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    postings.seek(LOG_POSTINGS_HEADER_BYTES);
+    QDataStream postingsIn(&postings);
+    for(qint64 block=0;block<segment.blocksIndexed;block++) {
+        qint64 offset;
+        QStringList tokens;
+        postingsIn >> offset >> tokens;
+        if (postingsIn.status()!=QDataStream::Ok) {
+            // Start the segment again, the next catch up rebuilds it.
+            qDebug()<<"Bad log postings"<<postings.fileName();
+            segment.blocksIndexed = 0;
+            segment.postingsBytes = LOG_POSTINGS_HEADER_BYTES;
+            segment.offsets.clear();
+            segment.postings.clear();
+            return;
+        }
+        addBlock(segment,offset,tokens);
+    }
+}
+
+void LogIndexWorker::addBlock(Segment &segment, qint64 offset, const QStringList &tokens)
+{
+    quint32 blockId = segment.offsets.size();
+    segment.offsets.append(offset);
+    for(const QString &token : tokens) {
+        segment.postings[token].append(blockId);
+    }
+}
+
+void LogIndexWorker::search(QString query, int maxHits)
+{
+    catchUp();
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<LogRecord> hits;
+    QStringList terms = tokenizeQuery(query);
+    QDir dir(this->folder);
+
+    // Newest segment first, older ones are only read in if there's room for more hits.
+    QList<qint64> starts = this->segments.keys();
+    for(int s=starts.size()-1;s>=0 && hits.size()<maxHits && !terms.isEmpty();s--) {
+        Segment &state = this->segments[starts.at(s)];
+        if (!state.loaded) {
+            loadPostings(starts.at(s),state);
+        }
+
+        // Intersect the posting lists, rarest term first so the working set stays small.
+        QList<QList<quint32>> lists;
+        for(const QString &term : terms) {
+            auto found = state.postings.constFind(term);
+            if (found==state.postings.constEnd()) {
+                lists.clear();
+                break;
+            }
+            lists.append(found.value());
+        }
+        std::sort(lists.begin(),lists.end(),[](const QList<quint32> &a, const QList<quint32> &b) { return a.size()<b.size(); });
+        QList<quint32> candidates = lists.isEmpty() ? QList<quint32>() : lists.first();
+        for(int x=1;x<lists.size() && !candidates.isEmpty();x++) {
+            QList<quint32> both;
+            std::set_intersection(candidates.begin(),candidates.end(),lists.at(x).begin(),lists.at(x).end(),std::back_inserter(both));
+            candidates = both;
+        }
+        if (candidates.isEmpty()) {
+            continue;
+        }
+
+        // Newest blocks first, a block only holds a candidate so every line still needs checking.
+        QFile segment(dir.filePath(QString::number(starts.at(s))+LOG_SEGMENT_SUFFIX));
+        if (!segment.open(QIODevice::ReadOnly)) {
+            continue; // Pruned since it was indexed
+        }
+        for(int x=candidates.size()-1;x>=0 && hits.size()<maxHits;x--) {
+            QList<LogRecord> records;
+            if (!LogArchive::readBlock(&segment,state.offsets.at(candidates.at(x)),records)) {
+                continue;
+            }
+            for(int y=records.size()-1;y>=0 && hits.size()<maxHits;y--) {
+                QStringList lineTokens = tokenize(records.at(y));
+                bool match = true;
+                for(const QString &term : terms) {
+                    if (!lineTokens.contains(term)) {
+                        match = false;
+                        break;
+                    }
+                }
+                if (match) {
+                    hits.append(records.at(y));
+                }
+            }
+        }
+    }
+    std::reverse(hits.begin(),hits.end());
+    emit searchFinished(query,hits,timer.nsecsElapsed());
+}
+
+LogIndex::LogIndex(LogArchive *archive, QObject *parent) : QObject(parent), archive(archive)
+{
+    this->worker = new LogIndexWorker(this->archive->getLogFolder());
+    this->worker->moveToThread(&this->workerThread);
+    connect(&this->workerThread,&QThread::started,this->worker,&LogIndexWorker::start);
+    connect(&this->workerThread,&QThread::finished,this->worker,&QObject::deleteLater);
+    connect(this,&LogIndex::searchRequested,this->worker,&LogIndexWorker::search);
+    connect(this->worker,&LogIndexWorker::searchFinished,this,&LogIndex::searchFinished);
+    this->workerThread.setObjectName("LogIndexWorker");
+    this->workerThread.start(QThread::LowestPriority);
+}
+
+LogIndex::~LogIndex()
+{
+    this->workerThread.quit();
+    this->workerThread.wait();
+}
+
+void LogIndex::search(QString query, int maxHits)
+{
+    // Get the latest lines on disk so the worker can index them before searching.
+    this->archive->flush();
+    emit searchRequested(query,maxHits);
+}
@@ -0,0 +1,86 @@
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QThread>
+#include <QHash>
+#include <QMap>
+#include <QTimer>
+#include "logarchive.h"
+
+// Does the work for LogIndex on its own low priority thread.
+class LogIndexWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogIndexWorker(QString folder);
+
+    static QStringList tokenize(const LogRecord &record);
+    static QStringList tokenizeQuery(QString query);
+
+public slots:
+    void start();
+    void catchUp(); // Index any blocks written since the last call.
+    void search(QString query, int maxHits);
+
+signals:
+    void searchFinished(QString query, QList<LogRecord> hits, qint64 elapsedNs);
+
+private:
+    class Segment {
+    public:
+        qint64 blocksIndexed; // Index entries covered by the postings file
+        qint64 postingsBytes; // Where the next block goes in the postings file
+        bool loaded; // Postings are only read in when a search needs them
+        QList<qint64> offsets; // A block's id is its position here, and in the segment's index
+        QHash<QString,QList<quint32>> postings; // Token to the blocks it appears in, ascending.
+    };
+
+    QString folder;
+    QMap<qint64,Segment> segments; // By start time, also the segment's file name
+    qint64 linesIndexed;
+    QTimer *catchUpTimer;
+
+    QString getPostingsName(qint64 segmentStart);
+    void readPostingsHeader(qint64 segmentStart, Segment &segment);
+    void loadPostings(qint64 segmentStart, Segment &segment);
+    static void addBlock(Segment &segment, qint64 offset, const QStringList &tokens);
+    static void addTokens(QStringList &tokens, QStringView text);
+};
+
+// An inverted index over the log archive. Tokens map to the archive blocks that contain
+// them, so a search only decompresses the blocks holding every term. Terms can be words,
+// numbers (xuids are just long numbers, xuid:<n> also works) or level:info, level:warn
+// and level:error.
+class LogIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LogIndex(LogArchive *archive, QObject *parent = nullptr);
+    ~LogIndex();
+
+    void search(QString query, int maxHits = 1000); // Newest hits are kept, results come via searchFinished.
+
+signals:
+    void searchFinished(QString query, QList<LogRecord> hits, qint64 elapsedNs);
+    void searchRequested(QString query, int maxHits);
+
+private:
+    LogArchive *archive;
+    QThread workerThread;
+    LogIndexWorker *worker;
+};
+
+#endif // LOGINDEX_H
@@ -0,0 +1,31 @@
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QString>
+#include <QList>
+#include <QMetaType>
+#include <server/bedrockserver.h>
+
+class LogRecord
+{
+public:
+    qint64 time; // ms since epoch
+    BedrockServer::OutputType type;
+    QString text;
+};
+
+Q_DECLARE_METATYPE(LogRecord)
+
+#endif // LOGRECORD_H
@@ -0,0 +1,315 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "logstore.h"
+#include <QHash>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+#define LOG_STORE_PAGE_BYTES (64*1024)
+#define LOG_STORE_STAMP_LENGTH 25 // '[2024-11-16 15:00:00:012 '
+
+LogStore::LogStore(int capacity)
+    : head(0),entryCount(0),maxEntries(capacity),lines(0),liveBytes(0),deadBytes(0)
+{
+}
+
+int LogStore::count() const
+{
+    return this->entryCount;
+}
+
+int LogStore::capacity() const
+{
+    return this->maxEntries;
+}
+
+void LogStore::setCapacity(int lines)
+{
+    if (lines<1 || lines==this->maxEntries) {
+        return;
+    }
+    if (this->entryCount>lines) {
+        removeOldest(this->entryCount-lines);
+    }
+    // Unroll the ring so it can grow or shrink.
+    QList<Entry> kept;
+    kept.reserve(this->entryCount);
+    for(int x=0;x<this->entryCount;x++) {
+        kept.append(entryAt(x));
+    }
+    this->entries = kept;
+    this->head = 0;
+    this->maxEntries = lines;
+}
+
+void LogStore::clear()
+{
+    this->entries.clear();
+    this->head = 0;
+    this->entryCount = 0;
+    this->lines = 0;
+    this->pages.clear();
+    this->strings.clear();
+    this->freeIds.clear();
+    this->lookup.clear();
+    this->liveBytes = 0;
+    this->deadBytes = 0;
+}
+
+int LogStore::countNewEntries(const QList<LogRecord> &records) const
+{
+    int ret = 0;
+    bool havePrevious = this->entryCount>0;
+    quint8 previousType = havePrevious ? entryAt(this->entryCount-1).type : 0;
+    bool previousStamped = havePrevious && entryAt(this->entryCount-1).stamp>=0;
+    QByteArray previous;
+    if (havePrevious) {
+        const StringRef &ref = this->strings.at(entryAt(this->entryCount-1).message);
+        previous = QByteArray(this->pages.at(ref.page).constData()+ref.offset,ref.length);
+    }
+
+    for(const LogRecord &record : records) {
+        qint64 stamp;
+        QByteArray message = splitLine(record.text,stamp);
+        if (havePrevious && previousType==(quint8)record.type && previousStamped==(stamp>=0) && previous==message) {
+            continue;
+        }
+        ret++;
+        havePrevious = true;
+        previousType = (quint8)record.type;
+        previousStamped = stamp>=0;
+        previous = message;
+    }
+    return ret;
+}
+
+bool LogStore::append(const LogRecord &record)
+{
+    qint64 stamp;
+    QByteArray message = splitLine(record.text,stamp);
+    this->lines++;
+
+    if (this->entryCount>0) {
+        Entry &last = this->entries[(this->head+this->entryCount-1) % this->maxEntries];
+        if (sameMessage(last,(quint8)record.type,stamp>=0,message)) {
+            last.repeats++;
+            last.lastDelta = (qint32)qMin(record.time-last.time,(qint64)std::numeric_limits<qint32>::max());
+            return false;
+        }
+    }
+
+    Entry entry;
+    entry.time = record.time;
+    entry.stamp = stamp;
+    entry.message = intern(message);
+    entry.repeats = 1;
+    entry.lastDelta = 0;
+    entry.type = (quint8)record.type;
+
+    int slot = (this->head + this->entryCount) % this->maxEntries;
+    if (slot<this->entries.size()) {
+        this->entries[slot] = entry;
+    } else {
+        this->entries.append(entry);
+    }
+    this->entryCount++;
+    return true;
+}
+
+void LogStore::removeOldest(int entries)
+{
+    entries = qMin(entries,this->entryCount);
+    for(int x=0;x<entries;x++) {
+        const Entry &entry = entryAt(0);
+        this->lines -= entry.repeats;
+        release(entry.message);
+        this->head = (this->head+1) % this->maxEntries;
+        this->entryCount--;
+    }
+}
+
+qint64 LogStore::time(int row) const
+{
+    return entryAt(row).time;
+}
+
+qint64 LogStore::lastTime(int row) const
+{
+    return entryAt(row).time + entryAt(row).lastDelta;
+}
+
+BedrockServer::OutputType LogStore::type(int row) const
+{
+    return (BedrockServer::OutputType)entryAt(row).type;
+}
+
+quint32 LogStore::repeats(int row) const
+{
+    return entryAt(row).repeats;
+}
+
+QString LogStore::text(int row) const
+{
+    const Entry &entry = entryAt(row);
+    const StringRef &ref = this->strings.at(entry.message);
+    QString message = QString::fromUtf8(this->pages.at(ref.page).constData()+ref.offset,ref.length);
+    return (entry.stamp>=0) ? unpackStamp(entry.stamp)+message : message;
+}
+
+qint64 LogStore::lineCount() const
+{
+    return this->lines;
+}
+
+qint64 LogStore::memoryUsed() const
+{
+    qint64 pageBytes = 0;
+    for(const QByteArray &page : this->pages) {
+        pageBytes += page.capacity();
+    }
+    return this->entries.capacity()*sizeof(Entry) +
+            this->strings.capacity()*sizeof(StringRef) +
+            this->freeIds.capacity()*sizeof(quint32) +
+            this->lookup.size()*(sizeof(size_t)+sizeof(quint32)+2*sizeof(void*)) + // Roughly, per hash node
+            pageBytes;
+}
+
+const LogStore::Entry &LogStore::entryAt(int row) const
+{
+    return this->entries.at((this->head + row) % this->maxEntries);
+}
+
+quint32 LogStore::intern(const QByteArray &utf8)
+{
+    size_t hash = qHash(utf8);
+    for(auto it=this->lookup.constFind(hash);it!=this->lookup.constEnd() && it.key()==hash;++it) {
+        StringRef &ref = this->strings[it.value()];
+        if (ref.length==(quint32)utf8.size() && std::memcmp(this->pages.at(ref.page).constData()+ref.offset,utf8.constData(),ref.length)==0) {
+            ref.refs++;
+            return it.value();
+        }
+    }
+
+    if (this->pages.isEmpty() || this->pages.last().size()+utf8.size()>this->pages.last().capacity()) {
+        QByteArray page;
+        page.reserve(qMax(LOG_STORE_PAGE_BYTES,(int)utf8.size()));
+        this->pages.append(page);
+    }
+    StringRef ref;
+    ref.page = this->pages.size()-1;
+    ref.offset = this->pages.last().size();
+    ref.length = utf8.size();
+    ref.refs = 1;
+    ref.hash = hash;
+    this->pages.last().append(utf8);
+    this->liveBytes += utf8.size();
+
+    quint32 id;
+    if (this->freeIds.isEmpty()) {
+        id = this->strings.size();
+        this->strings.append(ref);
+    } else {
+        id = this->freeIds.takeLast();
+        this->strings[id] = ref;
+    }
+    this->lookup.insert(hash,id);
+    return id;
+}
+
+void LogStore::release(quint32 id)
+{
+    StringRef &ref = this->strings[id];
+    if (--ref.refs>0) {
+        return;
+    }
+    this->lookup.remove(ref.hash,id);
+    this->freeIds.append(id);
+    this->liveBytes -= ref.length;
+    this->deadBytes += ref.length;
+
+    // Pages are append only, once most of what they hold has expired copy the rest out.
+    if (this->deadBytes>4*LOG_STORE_PAGE_BYTES && this->deadBytes>this->liveBytes) {
+        compact();
+    }
+}
+
+void LogStore::compact()
+{
+    QList<QByteArray> oldPages = this->pages;
+    this->pages.clear();
+
+    for(StringRef &ref : this->strings) {
+        if (ref.refs==0) {
+            continue;
+        }
+        if (this->pages.isEmpty() || this->pages.last().size()+(int)ref.length>this->pages.last().capacity()) {
+            QByteArray page;
+            page.reserve(qMax(LOG_STORE_PAGE_BYTES,(int)ref.length));
+            this->pages.append(page);
+        }
+        const char *data = oldPages.at(ref.page).constData()+ref.offset;
+        ref.page = this->pages.size()-1;
+        ref.offset = this->pages.last().size();
+        this->pages.last().append(data,ref.length);
+    }
+    this->deadBytes = 0;
+}
+
+bool LogStore::sameMessage(const Entry &entry, quint8 type, bool stamped, const QByteArray &message) const
+{
+    if (entry.type!=type || (entry.stamp>=0)!=stamped) {
+        return false;
+    }
+    const StringRef &ref = this->strings.at(entry.message);
+    return ref.length==(quint32)message.size() && std::memcmp(this->pages.at(ref.page).constData()+ref.offset,message.constData(),ref.length)==0;
+}
+
+QByteArray LogStore::splitLine(const QString &text, qint64 &stamp)
+{
+    // '[yyyy-MM-dd hh:mm:ss:zzz ' becomes the 17 digits as one number.
+    static const char pattern[] = "[0000-00-00 00:00:00:000 ";
+    stamp = -1;
+    if (text.size()<LOG_STORE_STAMP_LENGTH) {
+        return text.toUtf8();
+    }
+    qint64 packed = 0;
+    for(int x=0;x<LOG_STORE_STAMP_LENGTH;x++) {
+        QChar c = text.at(x);
+        if (pattern[x]=='0') {
+            if (c<'0' || c>'9') {
+                return text.toUtf8();
+            }
+            packed = packed*10 + (c.unicode()-'0');
+        } else if (c!=QLatin1Char(pattern[x])) {
+            return text.toUtf8();
+        }
+    }
+    stamp = packed;
+    return QStringView(text).mid(LOG_STORE_STAMP_LENGTH).toUtf8();
+}
+
+QString LogStore::unpackStamp(qint64 stamp)
+{
+    static const char pattern[] = "[0000-00-00 00:00:00:000 ";
+    QString ret(LOG_STORE_STAMP_LENGTH,' ');
+    for(int x=LOG_STORE_STAMP_LENGTH-1;x>=0;x--) {
+        if (pattern[x]=='0') {
+            ret[x] = QChar('0'+(int)(stamp%10));
+            stamp /= 10;
+        } else {
+            ret[x] = QLatin1Char(pattern[x]);
+        }
+    }
+    return ret;
+}
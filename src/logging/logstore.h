@@ -0,0 +1,91 @@
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QByteArray>
+#include <QList>
+#include <QMultiHash>
+#include "logrecord.h"
+
+// A ring of log entries kept as compactly as we reasonably can. Bedrock's
+// '[2024-11-16 15:00:00:012 ' timestamp is packed into an integer, the rest of the line
+// is interned as UTF-8 in arena pages so repeated messages (autosaves, player joins,
+// the same warning again) are stored once, and a line identical to the one before it
+// just bumps that entry's repeat count.
+class LogStore
+{
+public:
+    explicit LogStore(int capacity = 500000);
+
+    int count() const;
+    int capacity() const;
+    void setCapacity(int lines); // Keeps the newest entries that fit.
+    void clear();
+
+    int countNewEntries(const QList<LogRecord> &records) const; // How many entries appending these would add.
+    bool append(const LogRecord &record); // False if it was folded into the last entry. Never evicts, see removeOldest.
+    void removeOldest(int entries);
+
+    qint64 time(int row) const;
+    qint64 lastTime(int row) const;
+    BedrockServer::OutputType type(int row) const;
+    quint32 repeats(int row) const;
+    QString text(int row) const;
+
+    qint64 lineCount() const; // Lines held, counting repeats.
+    qint64 memoryUsed() const; // Approximate bytes, entries plus string storage.
+
+private:
+    class Entry {
+    public:
+        qint64 time;
+        qint64 stamp; // Packed server timestamp, -1 if the line didn't have one
+        quint32 message;
+        quint32 repeats;
+        qint32 lastDelta; // ms from time to the last repeat
+        quint8 type;
+    };
+    class StringRef {
+    public:
+        quint32 page;
+        quint32 offset;
+        quint32 length;
+        quint32 refs;
+        size_t hash;
+    };
+
+    QList<Entry> entries;
+    int head;
+    int entryCount;
+    int maxEntries;
+    qint64 lines;
+
+    QList<QByteArray> pages;
+    QList<StringRef> strings;
+    QList<quint32> freeIds;
+    QMultiHash<size_t,quint32> lookup;
+    qint64 liveBytes;
+    qint64 deadBytes;
+
+    const Entry &entryAt(int row) const;
+    quint32 intern(const QByteArray &utf8);
+    void release(quint32 id);
+    void compact();
+    bool sameMessage(const Entry &entry, quint8 type, bool stamped, const QByteArray &message) const;
+
+    static QByteArray splitLine(const QString &text, qint64 &stamp); // The message after any timestamp, as UTF-8
+    static QString unpackStamp(qint64 stamp);
+};
+
+#endif // LOGSTORE_H
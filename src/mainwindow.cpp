@@ -12,15 +12,17 @@
 */
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include <server/bedrockservermodel.h>
 #include <QFileDialog>
 #include <QSettings>
 #include <QDateTime>
 #include <QCloseEvent>
 #include <QTextEdit>
 #include <QDesktopServices>
-#include <QGridLayout>
+#include <QHeaderView>
 #include <QLineEdit>
 #include <QComboBox>
+#include <QLocale>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -33,6 +35,12 @@ MainWindow::MainWindow(QWidget *parent)
 
     this->server = new BedrockServer(this);
     this->backups = new BackupManager(this->server, this);
+    this->logArchive = new LogArchive(this->server, this);
+    this->logIndex = new LogIndex(this->logArchive, this);
+    this->telemetry = new ProcessTelemetry(this->server, this);
+    this->metricsExporter = new MetricsExporter(this->server, this->telemetry, this);
+    this->history = new MetricsHistory(this->server, this->telemetry, this);
+    this->sessions = new SessionStore(this->server, this);
 
     ui->copyright->setText(QString("<style>a {color: green;}</style>Version %1<br/>Built using <a href='mcbc:/qt'>Qt</a>, licenced under the <a href='mcbc:/gpl'>GNU GPL v3</a>. Latest version on <a href='https://github.com/mrrooster/minecraftbedrockconsole'>github</a>.").arg(qApp->applicationVersion()));
     ui->copyright->setStyleSheet("font-size: 8pt; color: grey;");
@@ -74,6 +82,11 @@ MainWindow::MainWindow(QWidget *parent)
     });
 
     ui->serverConsole->setServer(this->server);
+    ui->serverConsole->setLogArchive(this->logArchive);
+    ui->serverConsole->setLogIndex(this->logIndex);
+    setupTelemetry();
+    setupHistory();
+    setupPlayerAnalytics();
 
     //connect(this->server,&BedrockServer::serverOutput,this,&MainWindow::handleServerOutput);
     connect(this->server,&BedrockServer::serverStateChanged,this,&MainWindow::handleServerStateChange);
@@ -89,7 +102,9 @@ MainWindow::MainWindow(QWidget *parent)
     });
 
     connect(this->server,&BedrockServer::serverConfigurationUpdated,this,[=]() {
-        this->setupServerProperties();
+        if (this->server->GetCurrentState()!=BedrockServer::ServerRunning) {
+            return; // Whatever changed is used the next time it starts
+        }
         emit this->server->serverOutput(BedrockServer::WarningOutput,tr("Server configuration updated, server may need to be restarted."));
     });
 
@@ -169,7 +184,6 @@ void MainWindow::handleServerStateChange(BedrockServer::ServerState newState)
     } else if (newState==BedrockServer::ServerRunning) {
         this->ui->serverState->setStyleSheet("background-color: #ddffdd; color: black;"); // Green
         running=true;
-        setupServerProperties();
     }
 
     this->ui->startServer->setEnabled( startable );
@@ -177,6 +191,240 @@ void MainWindow::handleServerStateChange(BedrockServer::ServerState newState)
     this->ui->difficultySlider->setEnabled( running );
 }
 
+void MainWindow::setupTelemetry()
+{
+    if (!ProcessTelemetry::isSupported()) {
+        return;
+    }
+    for(int x=0;x<ProcessTelemetry::MetricCount;x++) {
+        ProcessTelemetry::Metric metric = (ProcessTelemetry::Metric)x;
+        SparklineWidget *sparkline = new SparklineWidget(ProcessTelemetry::metricName(metric),ProcessTelemetry::metricUnit(metric),this);
+        connect(sparkline,&SparklineWidget::resolutionChanged,this,[=]() {
+            sparkline->setSeries(this->telemetry->series(metric));
+        });
+        this->ui->telemetryLayout->addWidget(sparkline);
+        this->sparklines.append(sparkline);
+    }
+    connect(this->telemetry,&ProcessTelemetry::sampled,this,[=]() {
+        if (this->ui->tabWidget->currentIndex()!=0) {
+            return; // Not visible, they catch up on the next sample after switching back.
+        }
+        for(int x=0;x<this->sparklines.size();x++) {
+            this->sparklines.at(x)->setSeries(this->telemetry->series((ProcessTelemetry::Metric)x));
+        }
+    });
+}
+
+void MainWindow::setupHistory()
+{
+    for(int x=0;x<MetricsHistory::SeriesCount;x++) {
+        this->ui->historySeries->addItem(MetricsHistory::seriesName((MetricsHistory::Series)x),x);
+    }
+    this->ui->historyRange->addItem(tr("Last day"),24*60*60);
+    this->ui->historyRange->addItem(tr("Last week"),7*24*60*60);
+    this->ui->historyRange->addItem(tr("Last four weeks"),28*24*60*60);
+    this->ui->historyRange->addItem(tr("Last three months"),91*24*60*60);
+    this->ui->historyRange->addItem(tr("Last year"),365*24*60*60);
+    this->ui->historyRange->setCurrentIndex(1);
+
+    connect(this->ui->historySeries,&QComboBox::currentIndexChanged,this,&MainWindow::updateHistory);
+    connect(this->ui->historyRange,&QComboBox::currentIndexChanged,this,&MainWindow::updateHistory);
+    connect(this->ui->tabWidget,&QTabWidget::currentChanged,this,[=](int idx) {
+        if (idx==this->ui->tabWidget->indexOf(this->ui->tab_6)) {
+            this->updateHistory();
+        }
+    });
+    QTimer *refresh = new QTimer(this);
+    connect(refresh,&QTimer::timeout,this,[=]() {
+        if (this->ui->tabWidget->currentWidget()==this->ui->tab_6) {
+            this->updateHistory();
+        }
+    });
+    refresh->start(60*1000);
+}
+
+void MainWindow::updateHistory()
+{
+    MetricsHistory::Series series = (MetricsHistory::Series)this->ui->historySeries->currentData().toInt();
+    QString unit = MetricsHistory::seriesUnit(series);
+    QDateTime to = QDateTime::currentDateTime();
+    QDateTime from = to.addSecs(-this->ui->historyRange->currentData().toLongLong());
+    QList<TimeSeriesPoint> points = this->history->query(series,from,to,qMax(100,this->ui->historyChart->width()/2));
+    this->ui->historyChart->setPoints(points,from.toSecsSinceEpoch(),to.toSecsSinceEpoch(),unit);
+
+    if (points.isEmpty()) {
+        this->ui->historySummary->setText(QString());
+        return;
+    }
+    // The hour of the day with the highest average, to plan backups and restarts around.
+    double hourTotals[24] = {0};
+    int hourCounts[24] = {0};
+    const TimeSeriesPoint *peak = &points.first();
+    for(int x=0;x<points.size();x++) {
+        int hour = QDateTime::fromSecsSinceEpoch(points.at(x).time).time().hour();
+        hourTotals[hour] += points.at(x).value;
+        hourCounts[hour]++;
+        if (points.at(x).peak>peak->peak) {
+            peak = &points.at(x);
+        }
+    }
+    int busiest = -1;
+    for(int hour=0;hour<24;hour++) {
+        if (hourCounts[hour]>0 && (busiest<0 || hourTotals[hour]/hourCounts[hour]>hourTotals[busiest]/hourCounts[busiest])) {
+            busiest = hour;
+        }
+    }
+    QString summary = tr("Peak %1 %2 at %3.").arg(peak->peak,0,'f',1).arg(unit).arg(QDateTime::fromSecsSinceEpoch(peak->time).toString("ddd d MMM HH:mm"));
+    if (from.daysTo(to)>1) {
+        summary += " "+tr("Busiest hour of the day is %1:00, averaging %2 %3.").arg(busiest,2,10,QChar('0')).arg(hourTotals[busiest]/hourCounts[busiest],0,'f',1).arg(unit);
+    }
+    this->ui->historySummary->setText(summary);
+}
+
+void MainWindow::setupPlayerAnalytics()
+{
+    this->ui->playersRange->addItem(tr("Last day"),24*60*60);
+    this->ui->playersRange->addItem(tr("Last week"),7*24*60*60);
+    this->ui->playersRange->addItem(tr("Last four weeks"),28*24*60*60);
+    this->ui->playersRange->addItem(tr("Last three months"),91*24*60*60);
+    this->ui->playersRange->addItem(tr("Last year"),365*24*60*60);
+    this->ui->playersRange->setCurrentIndex(2);
+    this->ui->playersTable->sortByColumn(1,Qt::DescendingOrder);
+
+    connect(this->ui->playersRange,&QComboBox::currentIndexChanged,this,&MainWindow::updatePlayerAnalytics);
+    connect(this->ui->tabWidget,&QTabWidget::currentChanged,this,[=](int idx) {
+        if (idx==this->ui->tabWidget->indexOf(this->ui->tab_7)) {
+            this->updatePlayerAnalytics();
+        }
+    });
+    connect(this->sessions,&SessionStore::analysisFinished,this,[=](PlayerAnalytics analytics, qint64) {
+        this->showPlayerAnalytics(analytics);
+    });
+    QTimer *refresh = new QTimer(this);
+    connect(refresh,&QTimer::timeout,this,[=]() {
+        if (this->ui->tabWidget->currentWidget()==this->ui->tab_7) {
+            this->updatePlayerAnalytics();
+        }
+    });
+    refresh->start(60*1000);
+}
+
+void MainWindow::updatePlayerAnalytics()
+{
+    QDateTime to = QDateTime::currentDateTime();
+    this->sessions->analyse(to.addSecs(-this->ui->playersRange->currentData().toLongLong()),to);
+}
+
+void MainWindow::showPlayerAnalytics(const PlayerAnalytics &analytics)
+{
+    this->ui->playersChart->setPoints(analytics.hourly,analytics.from,analytics.to,tr("players"));
+
+    this->ui->playersTable->setSortingEnabled(false);
+    this->ui->playersTable->clear();
+    qint64 totalSeconds = 0;
+    for(int x=0;x<analytics.players.size();x++) {
+        const PlayerStats &player = analytics.players.at(x);
+        QTreeWidgetItem *item = new QTreeWidgetItem(this->ui->playersTable);
+        item->setText(0,player.name.isEmpty() ? player.xuid : player.name);
+        item->setToolTip(0,player.xuid);
+        item->setData(1,Qt::DisplayRole,qRound(player.playSeconds/360.0)/10.0);
+        item->setData(2,Qt::DisplayRole,player.sessions);
+        item->setData(3,Qt::DisplayRole,player.firstSeen);
+        item->setData(4,Qt::DisplayRole,player.lastSeen);
+        totalSeconds += player.playSeconds;
+    }
+    this->ui->playersTable->setSortingEnabled(true);
+
+    if (analytics.players.isEmpty()) {
+        this->ui->playersSummary->setText(tr("Nobody played in this time."));
+        return;
+    }
+    const TimeSeriesPoint *peak = &analytics.hourly.first();
+    for(int x=0;x<analytics.hourly.size();x++) {
+        if (analytics.hourly.at(x).peak>peak->peak) {
+            peak = &analytics.hourly.at(x);
+        }
+    }
+    QString summary = tr("%1 players, %2 hours played. Most online was %3 at %4.")
+            .arg(analytics.players.size()).arg(totalSeconds/3600.0,0,'f',1).arg(peak->peak)
+            .arg(QDateTime::fromSecsSinceEpoch(peak->time).toString("ddd d MMM HH:00"));
+    if (analytics.quietestHour>=0) {
+        summary += " "+tr("Quietest time for maintenance is %1 %2:00, averaging %3 players.")
+                .arg(QLocale().dayName(analytics.quietestHour/24+1))
+                .arg(analytics.quietestHour%24,2,10,QChar('0'))
+                .arg(analytics.quietestAverage,0,'f',1);
+    }
+    this->ui->playersSummary->setText(summary);
+}
+
+void MainWindow::setupPlayerList()
+{
+    this->playerFilter = new PlayerFilterModel(this);
+    this->playerFilter->setSourceModel(this->server->getServerModel());
+    this->ui->playerList->setModel(this->playerFilter);
+
+    this->ui->playerSort->addItem(tr("Permissions order"),PlayerFilterModel::ListOrder);
+    this->ui->playerSort->addItem(tr("Gamertag"),PlayerFilterModel::ByName);
+    this->ui->playerSort->addItem(tr("Last seen"),PlayerFilterModel::ByLastSeen);
+    this->ui->playerSort->addItem(tr("Play time"),PlayerFilterModel::ByPlayTime);
+    this->ui->playerSort->addItem(tr("Permission"),PlayerFilterModel::ByPermission);
+    connect(this->ui->playerSort,&QComboBox::currentIndexChanged,this,[=]() {
+        PlayerFilterModel::SortOrder order = (PlayerFilterModel::SortOrder)this->ui->playerSort->currentData().toInt();
+        if (order==PlayerFilterModel::ByPlayTime) {
+            this->sessions->totalPlayTimes();
+        }
+        this->playerFilter->setSortOrder(order);
+    });
+    connect(this->sessions,&SessionStore::playTimesFinished,this->playerFilter,&PlayerFilterModel::setPlayTimes);
+
+    // Several players can be selected and given a permission level in one go.
+    auto selectedXuids = [=]() {
+        QSet<QString> xuids;
+        const QModelIndexList rows = this->ui->playerList->selectionModel()->selectedRows();
+        for(const QModelIndex &index : rows) {
+            QString xuid = index.data(BedrockServerModel::XuidRole).toString();
+            if (!xuid.isEmpty()) {
+                xuids.insert(xuid); // Online players are in two branches
+            }
+        }
+        return xuids;
+    };
+    auto updateSelection = [=]() {
+        int count = selectedXuids().size();
+        this->ui->playerSelectionCount->setText(count>0 ? tr("%Ln player(s) selected","",count) : QString());
+        this->ui->playerSelectionPermission->setEnabled(count>0);
+        this->ui->playerSelectionApply->setEnabled(count>0);
+    };
+    connect(this->ui->playerList->selectionModel(),&QItemSelectionModel::selectionChanged,this,updateSelection);
+    connect(this->ui->playerSelectionApply,&QPushButton::clicked,this,[=]() {
+        BedrockServer::PermissionChanges changes;
+        BedrockServer::PermissionLevel level = (BedrockServer::PermissionLevel)this->ui->playerSelectionPermission->currentIndex();
+        const QSet<QString> xuids = selectedXuids();
+        for(const QString &xuid : xuids) {
+            changes.levels.insert(xuid,level);
+        }
+        this->server->applyPermissionChanges(changes);
+    });
+    updateSelection();
+    connect(this->ui->tabWidget,&QTabWidget::currentChanged,this,[=](int idx) {
+        if (idx==this->ui->tabWidget->indexOf(this->ui->tab_3) && this->playerFilter->getSortOrder()==PlayerFilterModel::ByPlayTime) {
+            this->sessions->totalPlayTimes();
+        }
+    });
+
+    // Typing is given a moment to settle, each search filters every known player.
+    QTimer *searchDelay = new QTimer(this);
+    searchDelay->setSingleShot(true);
+    searchDelay->setInterval(200);
+    connect(this->ui->playerFilter,&QLineEdit::textChanged,searchDelay,qOverload<>(&QTimer::start));
+    connect(searchDelay,&QTimer::timeout,this,[=]() {
+        this->playerFilter->setSearchText(this->ui->playerFilter->text());
+        if (!this->ui->playerFilter->text().isEmpty()) {
+            this->ui->playerList->expandAll();
+        }
+    });
+}
+
 void MainWindow::setOptions()
 {
     QSettings settings;
@@ -184,6 +432,15 @@ void MainWindow::setOptions()
     this->ui->serverFolder->setText(getServerRootFolder());
     this->ui->invalidServerLocationLabel->setHidden(serverLocationValid());
 
+    this->ui->floodLinesPerSecond->setText(QString::number(this->server->getOutputThrottle()->maxLinesPerSecond()));
+    this->ui->logArchiveEnabled->setChecked(this->logArchive->getEnabled());
+    this->ui->logRetentionDays->setText(QString::number(this->logArchive->getRetentionDays()));
+    this->ui->logRetentionDays->setEnabled(this->logArchive->getEnabled());
+    this->ui->telemetryIntervalSeconds->setText(QString::number(this->telemetry->getSampleInterval()/1000));
+    this->ui->telemetryIntervalSeconds->setEnabled(ProcessTelemetry::isSupported());
+    this->ui->metricsEnabled->setChecked(this->metricsExporter->getEnabled());
+    this->ui->metricsPort->setText(QString::number(this->metricsExporter->getPort()));
+
     settings.beginGroup("backup");
     this->ui->backupFolder->setText(settings.value("autoBackupFolder","").toString());
     this->ui->backupOnJoin->setChecked(settings.value("backupOnJoin").toBool());
@@ -304,6 +561,45 @@ void MainWindow::setupUi()
         this->ui->restrictBackupAge->setText(QString(tr("Delete backups older than %Ln day(s)","backup_age",value)));
     });
 
+    connect(this->ui->floodLinesPerSecond,&QLineEdit::textChanged,this,[=](QString value) {
+        bool parseable = false;
+        int val = value.toInt(&parseable);
+        if (parseable) {
+            this->server->setOutputFloodLinesPerSecond(val);
+        }
+    });
+
+    connect(this->ui->logArchiveEnabled,&QCheckBox::stateChanged,this->logArchive,&LogArchive::setEnabled);
+    connect(this->ui->logArchiveEnabled,&QCheckBox::stateChanged,this->ui->logRetentionDays,&QLineEdit::setEnabled);
+    connect(this->ui->logRetentionDays,&QLineEdit::textChanged,this,[=](QString value) {
+        bool parseable = false;
+        int val = value.toInt(&parseable);
+        if (parseable) {
+            this->logArchive->setRetentionDays(val);
+        }
+    });
+
+    connect(this->ui->telemetryIntervalSeconds,&QLineEdit::textChanged,this,[=](QString value) {
+        bool parseable = false;
+        int val = value.toInt(&parseable);
+        if (parseable && val>0) {
+            this->telemetry->setSampleInterval(val*1000);
+        }
+    });
+
+    connect(this->ui->metricsEnabled,&QCheckBox::stateChanged,this->metricsExporter,&MetricsExporter::setEnabled);
+    // Only once typing is done, every keystroke would rebind to a partial port number.
+    connect(this->ui->metricsPort,&QLineEdit::editingFinished,this,[=]() {
+        bool parseable = false;
+        int val = this->ui->metricsPort->text().toInt(&parseable);
+        if (parseable && val!=this->metricsExporter->getPort()) {
+            this->metricsExporter->setPort(val);
+        }
+    });
+    connect(this->metricsExporter,&MetricsExporter::listenStateChanged,this,[=](bool listening, QString error) {
+        this->ui->metricsStatus->setText(listening ? tr("Serving /metrics") : error);
+    });
+
     connect(this->ui->difficultySlider,&QSlider::valueChanged,this->server,&BedrockServer::setDifficulty);
 
     // Player widget
@@ -312,7 +608,7 @@ void MainWindow::setupUi()
             this->playerInfoWidget->deleteLater();
             this->playerInfoWidget=nullptr;
         }
-        QString xuid = this->server->getXuidFromIndex(index);
+        QString xuid = this->server->getXuidFromIndex(this->playerFilter->mapToSource(index));
         if (xuid!="") {
             this->playerInfoWidget = new PlayerInfoWidget(this->server,xuid,this);
             this->ui->playerListLayout->addWidget(this->playerInfoWidget);
@@ -326,8 +622,7 @@ void MainWindow::setupUi()
     setOptions();
     this->ui->restrictBackupAge->setText(QString(tr("Delete backups older than %Ln day(s)","backup_age",this->ui->restrictBackupAgeSlider->value())));
 
-    // Set the model for the treeview
-    this->ui->playerList->setModel(this->server->getServerModel());
+    setupPlayerList();
 
 
     this->ui->onlineBar->setServer(this->server);
@@ -336,10 +631,12 @@ void MainWindow::setupUi()
     this->ui->tabWidget->setCurrentIndex( serverLocationValid() ? 0 : 2 );
 
     // Server properties
+    setupServerProperties();
     connect(this->ui->saveConfig,&QPushButton::clicked,this->server,&BedrockServer::saveConfiguration);
     connect(this->ui->saveConfigAndRestart,&QPushButton::clicked,this,[=](){
-        this->server->saveConfiguration();
-        this->server->restartServerAfter(this->ui->restartAfterSeconds->text().toInt() * 1000);
+        if (this->server->saveConfiguration()) {
+            this->server->restartServerAfter(this->ui->restartAfterSeconds->text().toInt() * 1000);
+        }
     });
 
     // Restart delay
@@ -364,77 +661,14 @@ void MainWindow::setupUi()
 
 void MainWindow::setupServerProperties()
 {
-    if (this->server) {
-        auto props = this->server->serverConfiguration();
-        QWidget *w = new QWidget();
-        QGridLayout *l = new QGridLayout(w);
-
-        this->ui->serverPropertiesScrollArea->setWidget(w);
-        //l->setRowWrapPolicy(QFormLayout::WrapAllRows);
-        //l->setFieldGrowthPolicy(QFormLayout::ExpandingFieldsGrow);
-        int row=0;
-        for(auto x=props.constBegin();x!=props.constEnd();x++) {
-            BedrockServer::ConfigEntry *conf = (*x);
-
-            QLabel *label = new QLabel();
-            label->setWordWrap(true);
-            label->setText(QString("<b>%1</b><br/><i>%2</i>").arg(conf->name).arg(conf->help));
-            label->setToolTip(conf->help);
-            label->setSizePolicy(QSizePolicy::MinimumExpanding,QSizePolicy::Minimum);
-            QWidget *value;
-            if (conf->value.metaType().id()==QMetaType::Bool) {
-                QComboBox *valueBox = new QComboBox();
-                valueBox->addItem("true");
-                valueBox->addItem("false");
-                valueBox->setCurrentIndex(conf->value.toBool()?0:1);
-
-                connect(valueBox,&QComboBox::currentTextChanged,this,[=](QString text) {
-                   conf->newValue = text;
-                   if (conf->newValue!=conf->value) {
-                       valueBox->setStyleSheet("color:blue;");
-                   } else {
-                       valueBox->setStyleSheet("color:black;");
-                   }
-                });
-
-                value = valueBox;
-            } else if (conf->possibleValues.size()>0) {
-                QComboBox *valueBox = new QComboBox();
-                valueBox->addItems(conf->possibleValues);
-                valueBox->setCurrentIndex(conf->possibleValues.indexOf(conf->value.toString()));
-
-                connect(valueBox,&QComboBox::currentTextChanged,this,[=](QString text) {
-                   conf->newValue = text;
-                   if (conf->newValue!=conf->value) {
-                       valueBox->setStyleSheet("color:blue;");
-                   } else {
-                       valueBox->setStyleSheet("color:black;");
-                   }
-                });
-
-                value = valueBox;
-            } else {
-                QLineEdit *valueEdit = new QLineEdit();
-                valueEdit->setText(conf->value.toString());
-                value = valueEdit;
-
-                connect(valueEdit,&QLineEdit::textChanged,this,[=](QString text) {
-                   conf->newValue = text;
-                   if (conf->newValue!=conf->value) {
-                       valueEdit->setStyleSheet("color:blue;");
-                   } else {
-                       valueEdit->setStyleSheet("color:black;");
-                   }
-                });
-            }
-            value->setMaximumWidth(300);
-            value->setSizePolicy(QSizePolicy::Maximum,QSizePolicy::Maximum);
-
-            l->addWidget(label,row,0);
-            l->addWidget(value,row,1);
-            row++;
-        }
-    }
+    // Rows follow the config store, an editor is only made for the value being edited.
+    this->serverPropertiesModel = new ServerPropertiesModel(this->server->getConfigStore(),this);
+    this->ui->serverProperties->setModel(this->serverPropertiesModel);
+    this->ui->serverProperties->setItemDelegateForColumn(ServerPropertiesModel::ValueColumn,new ServerPropertyDelegate(this->ui->serverProperties));
+    this->ui->serverProperties->header()->resizeSection(ServerPropertiesModel::NameColumn,320);
+    connect(this->ui->serverProperties->selectionModel(),&QItemSelectionModel::currentRowChanged,this,[=](const QModelIndex &current) {
+        this->ui->serverPropertyHelp->setText(current.siblingAtColumn(ServerPropertiesModel::NameColumn).data(Qt::ToolTipRole).toString());
+    });
 }
 
 QString MainWindow::getServerRootFolder()
@@ -447,7 +681,7 @@ bool MainWindow::serverLocationValid()
     QString serverRoot = getServerRootFolder();
     QDir serverRootDir(serverRoot);
 
-    return (serverRoot!="" && serverRootDir.exists() && serverRootDir.exists("bedrock_server.exe"));
+    return (serverRoot!="" && serverRootDir.exists() && serverRootDir.exists(BedrockServer::serverExecutableName()));
 }
 
 void MainWindow::setBackupDelayLabel(int delay)
@@ -17,7 +17,16 @@
 #include <QLabel>
 #include <server/bedrockserver.h>
 #include <backup/backupmanager.h>
+#include <logging/logarchive.h>
+#include <logging/logindex.h>
+#include <telemetry/processtelemetry.h>
+#include <telemetry/metricsexporter.h>
+#include <telemetry/metricshistory.h>
+#include <players/sessionstore.h>
+#include <widgets/sparklinewidget.h>
 #include <widgets/playerinfowidget.h>
+#include <widgets/playerfiltermodel.h>
+#include <widgets/serverpropertiesmodel.h>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -38,13 +47,29 @@ private:
     Ui::MainWindow *ui;
     BedrockServer *server;
     BackupManager *backups;
+    LogArchive *logArchive;
+    LogIndex *logIndex;
+    ProcessTelemetry *telemetry;
+    MetricsExporter *metricsExporter;
+    MetricsHistory *history;
+    SessionStore *sessions;
+    QList<SparklineWidget*> sparklines; // One per ProcessTelemetry::Metric
     PlayerInfoWidget *playerInfoWidget;
+    PlayerFilterModel *playerFilter;
+    ServerPropertiesModel *serverPropertiesModel;
     QLabel *statusBarWidget;
     bool shuttingDown;
 
     void setOptions();
     void setupUi();
     void setupServerProperties();
+    void setupTelemetry();
+    void setupHistory();
+    void updateHistory();
+    void setupPlayerAnalytics();
+    void updatePlayerAnalytics();
+    void showPlayerAnalytics(const PlayerAnalytics &analytics);
+    void setupPlayerList();
     QString getServerRootFolder();
     bool serverLocationValid();
     void setBackupTimerActiveState(bool active);
@@ -0,0 +1,419 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "sessionstore.h"
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QDir>
+#include <server/playermappings.h>
+#include <QDebug>
+#include <algorithm>
+
+#define SESSION_HANDOFF_MS 1000
+#define SESSION_HEARTBEAT_MS 60000
+#define SESSION_HOUR 3600
+#define SESSION_WEEK_HOURS (7*24)
+
+SessionStoreWorker::SessionStoreWorker(QString fileName)
+    : QObject(nullptr),fileName(fileName),connectionName("sessions"),longestSession(0),heartbeatTimer(nullptr)
+{
+}
+
+void SessionStoreWorker::start()
+{
+    QDir().mkpath(QFileInfo(this->fileName).absolutePath());
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE",this->connectionName);
+    db.setDatabaseName(this->fileName);
+    if (!db.open()) {
+        qDebug()<<"Can't open session store"<<this->fileName<<db.lastError().text();
+        return;
+    }
+    const char *schema[] = {
+        "PRAGMA journal_mode=WAL",
+        "PRAGMA synchronous=NORMAL",
+        "CREATE TABLE IF NOT EXISTS players (xuid TEXT PRIMARY KEY, name TEXT NOT NULL, first_seen INTEGER NOT NULL, last_seen INTEGER NOT NULL) WITHOUT ROWID",
+        "CREATE TABLE IF NOT EXISTS sessions (id INTEGER PRIMARY KEY, xuid TEXT NOT NULL, joined_at INTEGER NOT NULL, left_at INTEGER)",
+        "CREATE INDEX IF NOT EXISTS sessions_by_time ON sessions (joined_at, left_at, xuid)",
+        "CREATE INDEX IF NOT EXISTS sessions_open ON sessions (xuid, joined_at) WHERE left_at IS NULL",
+        "CREATE TABLE IF NOT EXISTS meta (key TEXT PRIMARY KEY, value INTEGER NOT NULL) WITHOUT ROWID"
+    };
+    QSqlQuery query(db);
+    for(const char *statement : schema) {
+        if (!query.exec(statement)) {
+            qDebug()<<"Session store schema failed"<<statement<<query.lastError().text();
+        }
+    }
+    this->longestSession = metaValue("longestSession");
+    if (metaValue("importedMappings")==0) {
+        importMappings();
+    }
+
+    // Anything still open wasn't ended by a stop, the console or machine went away. End
+    // those sessions at the last heartbeat, the last time the console was known to be up.
+    qint64 heartbeat = metaValue("heartbeat");
+    if (heartbeat>0) {
+        db.transaction();
+        closeSessions(QString(),heartbeat);
+        db.commit();
+    }
+
+    this->heartbeatTimer = new QTimer(this);
+    this->heartbeatTimer->setInterval(SESSION_HEARTBEAT_MS);
+    connect(this->heartbeatTimer,&QTimer::timeout,this,[=]() {
+        setMetaValue("heartbeat",QDateTime::currentSecsSinceEpoch());
+    });
+    this->heartbeatTimer->start();
+    setMetaValue("heartbeat",QDateTime::currentSecsSinceEpoch());
+}
+
+void SessionStoreWorker::writeEvents(QList<SessionEvent> events)
+{
+    QSqlDatabase db = QSqlDatabase::database(this->connectionName,false);
+    if (!db.isOpen()) {
+        return;
+    }
+    db.transaction();
+    QSqlQuery seen(db);
+    seen.prepare("INSERT INTO players (xuid,name,first_seen,last_seen) VALUES (:xuid,:name,:first,:last) "
+                 "ON CONFLICT(xuid) DO UPDATE SET name=excluded.name,last_seen=excluded.last_seen");
+    QSqlQuery joined(db);
+    joined.prepare("INSERT INTO sessions (xuid,joined_at) VALUES (:xuid,:time)");
+    for(int x=0;x<events.size();x++) {
+        const SessionEvent &event = events.at(x);
+        // A join for someone already online means the leave was missed, end that one first.
+        closeSessions(event.xuid,event.time);
+        if (event.xuid.isEmpty()) {
+            continue;
+        }
+        seen.bindValue(":xuid",event.xuid);
+        seen.bindValue(":name",event.name);
+        seen.bindValue(":first",event.time);
+        seen.bindValue(":last",event.time);
+        if (!seen.exec()) {
+            qDebug()<<"Session store player update failed"<<seen.lastError().text();
+        }
+        if (event.joined) {
+            joined.bindValue(":xuid",event.xuid);
+            joined.bindValue(":time",event.time);
+            if (!joined.exec()) {
+                qDebug()<<"Session store join failed"<<joined.lastError().text();
+            }
+        }
+    }
+    if (!db.commit()) {
+        qDebug()<<"Session store commit failed"<<db.lastError().text();
+        db.rollback();
+    }
+}
+
+void SessionStoreWorker::closeSessions(const QString &xuid, qint64 time)
+{
+    QSqlDatabase db = QSqlDatabase::database(this->connectionName,false);
+    QString openSessions = xuid.isEmpty() ? QString("left_at IS NULL") : QString("left_at IS NULL AND xuid=:xuid");
+
+    QSqlQuery query(db);
+    query.prepare("SELECT MIN(joined_at) FROM sessions WHERE "+openSessions);
+    if (!xuid.isEmpty()) {
+        query.bindValue(":xuid",xuid);
+    }
+    if (!query.exec() || !query.next() || query.isNull(0)) {
+        return; // Nothing open
+    }
+    qint64 longest = time-query.value(0).toLongLong();
+    if (longest>this->longestSession) {
+        this->longestSession = longest;
+        setMetaValue("longestSession",longest);
+    }
+    if (xuid.isEmpty()) {
+        query.prepare("UPDATE players SET last_seen=:time WHERE xuid IN (SELECT xuid FROM sessions WHERE left_at IS NULL)");
+        query.bindValue(":time",time);
+        query.exec();
+    }
+    query.prepare("UPDATE sessions SET left_at=MAX(joined_at,:time) WHERE "+openSessions);
+    query.bindValue(":time",time);
+    if (!xuid.isEmpty()) {
+        query.bindValue(":xuid",xuid);
+    }
+    if (!query.exec()) {
+        qDebug()<<"Session store close failed"<<query.lastError().text();
+    }
+}
+
+void SessionStoreWorker::analyse(qint64 from, qint64 to)
+{
+    QElapsedTimer timer;
+    timer.start();
+    PlayerAnalytics analytics;
+    analytics.from = from;
+    analytics.to = to;
+    QSqlDatabase db = QSqlDatabase::database(this->connectionName,false);
+    if (!db.isOpen() || to<=from) {
+        emit analysisFinished(analytics,timer.nsecsElapsed());
+        return;
+    }
+
+    // A closed session overlapping the range started no more than the longest session
+    // before it, which keeps the scan to a range of sessions_by_time. Open sessions come
+    // from the partial index.
+    class Session {
+    public:
+        QString xuid;
+        qint64 start;
+        qint64 end;
+    };
+    QList<Session> sessions;
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT xuid,joined_at,left_at FROM sessions WHERE joined_at BETWEEN :earliest AND :to AND left_at>:from");
+    query.bindValue(":earliest",from-this->longestSession);
+    query.bindValue(":to",to);
+    query.bindValue(":from",from);
+    if (query.exec()) {
+        while (query.next()) {
+            sessions.append({query.value(0).toString(),qMax(from,query.value(1).toLongLong()),qMin(to,query.value(2).toLongLong())});
+        }
+    }
+    query.prepare("SELECT xuid,joined_at FROM sessions WHERE left_at IS NULL AND joined_at<:to");
+    query.bindValue(":to",to);
+    if (query.exec()) {
+        while (query.next()) {
+            sessions.append({query.value(0).toString(),qMax(from,query.value(1).toLongLong()),qMin(to,now)});
+        }
+    }
+
+    // Play time per player, and player seconds per hour for the averages.
+    qint64 firstHour = from-from%SESSION_HOUR;
+    int hours = (int)((to-firstHour+SESSION_HOUR-1)/SESSION_HOUR);
+    QList<double> playerSeconds(hours,0);
+    QList<QPair<qint64,int>> changes;
+    QHash<QString,int> playerRows;
+    for(int x=0;x<sessions.size();x++) {
+        const Session &session = sessions.at(x);
+        if (session.end<session.start) {
+            continue;
+        }
+        int row = playerRows.value(session.xuid,-1);
+        if (row<0) {
+            row = analytics.players.size();
+            playerRows.insert(session.xuid,row);
+            analytics.players.append(PlayerStats());
+            analytics.players.last().xuid = session.xuid;
+        }
+        analytics.players[row].playSeconds += session.end-session.start;
+        analytics.players[row].sessions++;
+        changes.append(qMakePair(session.start,1));
+        changes.append(qMakePair(session.end,-1));
+        for(qint64 hour=firstHour+(session.start-firstHour)/SESSION_HOUR*SESSION_HOUR;hour<session.end;hour+=SESSION_HOUR) {
+            playerSeconds[(hour-firstHour)/SESSION_HOUR] += qMin(session.end,hour+SESSION_HOUR)-qMax(session.start,hour);
+        }
+    }
+
+    // Sweep the joins and leaves in time order for the most players online in each hour.
+    std::sort(changes.begin(),changes.end());
+    double weekTotals[SESSION_WEEK_HOURS] = {0};
+    int weekCounts[SESSION_WEEK_HOURS] = {0};
+    int online = 0;
+    int change = 0;
+    for(int hour=0;hour<hours;hour++) {
+        qint64 start = firstHour+(qint64)hour*SESSION_HOUR;
+        int peak = online;
+        while (change<changes.size() && changes.at(change).first<start+SESSION_HOUR) {
+            online += changes.at(change).second;
+            peak = qMax(peak,online);
+            change++;
+        }
+        double average = playerSeconds.at(hour)/SESSION_HOUR;
+        analytics.hourly.append({start,average,(double)peak});
+        QDateTime local = QDateTime::fromSecsSinceEpoch(start);
+        int weekHour = (local.date().dayOfWeek()-1)*24+local.time().hour();
+        weekTotals[weekHour] += average;
+        weekCounts[weekHour]++;
+    }
+    // The quietest hour of the week is the one to schedule restarts and maintenance in.
+    if (hours>=SESSION_WEEK_HOURS) {
+        for(int hour=0;hour<SESSION_WEEK_HOURS;hour++) {
+            if (weekCounts[hour]>0 && (analytics.quietestHour<0 || weekTotals[hour]/weekCounts[hour]<analytics.quietestAverage)) {
+                analytics.quietestHour = hour;
+                analytics.quietestAverage = weekTotals[hour]/weekCounts[hour];
+            }
+        }
+    }
+
+    query.prepare("SELECT name,first_seen,last_seen FROM players WHERE xuid=:xuid");
+    for(int x=0;x<analytics.players.size();x++) {
+        PlayerStats &player = analytics.players[x];
+        query.bindValue(":xuid",player.xuid);
+        if (query.exec() && query.next()) {
+            player.name = query.value(0).toString();
+            player.firstSeen = QDateTime::fromSecsSinceEpoch(query.value(1).toLongLong());
+            player.lastSeen = QDateTime::fromSecsSinceEpoch(query.value(2).toLongLong());
+        }
+    }
+    std::sort(analytics.players.begin(),analytics.players.end(),[](const PlayerStats &a, const PlayerStats &b) {
+        return a.playSeconds>b.playSeconds;
+    });
+    emit analysisFinished(analytics,timer.nsecsElapsed());
+}
+
+void SessionStoreWorker::totalPlayTimes()
+{
+    QHash<QString,qint64> seconds;
+    QSqlQuery query(QSqlDatabase::database(this->connectionName,false));
+    query.setForwardOnly(true);
+    query.prepare("SELECT xuid,SUM(COALESCE(left_at,:now)-joined_at) FROM sessions GROUP BY xuid");
+    query.bindValue(":now",QDateTime::currentSecsSinceEpoch());
+    if (query.exec()) {
+        while (query.next()) {
+            seconds.insert(query.value(0).toString(),query.value(1).toLongLong());
+        }
+    }
+    emit playTimesFinished(seconds);
+}
+
+void SessionStoreWorker::close()
+{
+    if (this->heartbeatTimer) {
+        this->heartbeatTimer->stop();
+    }
+    {
+        QSqlDatabase db = QSqlDatabase::database(this->connectionName,false);
+        if (db.isOpen()) {
+            setMetaValue("heartbeat",QDateTime::currentSecsSinceEpoch());
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(this->connectionName);
+}
+
+void SessionStoreWorker::importMappings()
+{
+    // Players the console knew before the store existed keep their last seen time, it's
+    // the best there is for first seen too.
+    QSqlDatabase db = QSqlDatabase::database(this->connectionName,false);
+    db.transaction();
+    QSqlQuery query(db);
+    query.prepare("INSERT OR IGNORE INTO players (xuid,name,first_seen,last_seen) VALUES (:xuid,:name,:first,:last)");
+    PlayerMappings::readSnapshot(PlayerMappings::defaultFolder(),[&](const QString &xuid, const PlayerMappings::Mapping &mapping) {
+        qint64 lastSeen = mapping.lastSeen.toSecsSinceEpoch();
+        query.bindValue(":xuid",xuid);
+        query.bindValue(":name",mapping.name);
+        query.bindValue(":first",lastSeen);
+        query.bindValue(":last",lastSeen);
+        query.exec();
+    });
+    setMetaValue("importedMappings",1);
+    db.commit();
+}
+
+qint64 SessionStoreWorker::metaValue(const QString &key)
+{
+    QSqlQuery query(QSqlDatabase::database(this->connectionName,false));
+    query.prepare("SELECT value FROM meta WHERE key=:key");
+    query.bindValue(":key",key);
+    return (query.exec() && query.next()) ? query.value(0).toLongLong() : 0;
+}
+
+void SessionStoreWorker::setMetaValue(const QString &key, qint64 value)
+{
+    QSqlQuery query(QSqlDatabase::database(this->connectionName,false));
+    query.prepare("INSERT OR REPLACE INTO meta (key,value) VALUES (:key,:value)");
+    query.bindValue(":key",key);
+    query.bindValue(":value",value);
+    if (!query.exec()) {
+        qDebug()<<"Session store meta update failed"<<key<<query.lastError().text();
+    }
+}
+
+SessionStore::SessionStore(BedrockServer *server, QObject *parent) : QObject(parent), server(server)
+{
+    qRegisterMetaType<SessionEvent>("SessionEvent");
+    qRegisterMetaType<QList<SessionEvent>>("QList<SessionEvent>");
+    qRegisterMetaType<PlayerAnalytics>("PlayerAnalytics");
+    qRegisterMetaType<QHash<QString,qint64>>("QHash<QString,qint64>");
+
+    QString fileName = QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("sessions.sqlite");
+    this->worker = new SessionStoreWorker(fileName);
+    this->worker->moveToThread(&this->workerThread);
+    connect(&this->workerThread,&QThread::started,this->worker,&SessionStoreWorker::start);
+    connect(this,&SessionStore::writeEvents,this->worker,&SessionStoreWorker::writeEvents);
+    connect(this,&SessionStore::analysisRequested,this->worker,&SessionStoreWorker::analyse);
+    connect(this->worker,&SessionStoreWorker::analysisFinished,this,&SessionStore::analysisFinished);
+    connect(this,&SessionStore::playTimesRequested,this->worker,&SessionStoreWorker::totalPlayTimes);
+    connect(this->worker,&SessionStoreWorker::playTimesFinished,this,&SessionStore::playTimesFinished);
+    this->workerThread.setObjectName("SessionStoreWorker");
+    this->workerThread.start(QThread::LowPriority);
+
+    this->pendingTimer.setSingleShot(true);
+    this->pendingTimer.setInterval(SESSION_HANDOFF_MS);
+    connect(&this->pendingTimer,&QTimer::timeout,this,&SessionStore::flush);
+
+    connect(this->server,&BedrockServer::playerConnected,this,[=](QString name, QString xuid) {
+        this->append(xuid,name,true);
+    });
+    connect(this->server,&BedrockServer::playerDisconnected,this,[=](QString name, QString xuid) {
+        this->append(xuid,name,false);
+    });
+    connect(this->server,&BedrockServer::serverStateChanged,this,[=](BedrockServer::ServerState state) {
+        if (state!=BedrockServer::ServerRunning) {
+            this->append(QString(),QString(),false);
+        }
+    });
+}
+
+SessionStore::~SessionStore()
+{
+    flush();
+    QMetaObject::invokeMethod(this->worker,&SessionStoreWorker::close,Qt::BlockingQueuedConnection);
+    this->workerThread.quit();
+    this->workerThread.wait();
+    delete this->worker;
+}
+
+void SessionStore::analyse(QDateTime from, QDateTime to)
+{
+    // Queued behind anything pending, so the answer includes the latest joins and leaves.
+    flush();
+    emit analysisRequested(from.toSecsSinceEpoch(),to.toSecsSinceEpoch());
+}
+
+void SessionStore::totalPlayTimes()
+{
+    flush();
+    emit playTimesRequested();
+}
+
+void SessionStore::flush()
+{
+    this->pendingTimer.stop();
+    if (!this->pending.isEmpty()) {
+        emit writeEvents(this->pending);
+        this->pending.clear();
+    }
+}
+
+void SessionStore::append(QString xuid, QString name, bool joined)
+{
+    SessionEvent event;
+    event.time = QDateTime::currentSecsSinceEpoch();
+    event.xuid = xuid;
+    event.name = name;
+    event.joined = joined;
+    this->pending.append(event);
+    if (!this->pendingTimer.isActive()) {
+        this->pendingTimer.start();
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QDateTime>
+#include <QHash>
+#include <QMetaType>
+#include <server/bedrockserver.h>
+#include <telemetry/timeseriesblock.h>
+
+class SessionEvent
+{
+public:
+    qint64 time; // Seconds since the epoch
+    QString xuid; // Empty when the server stopped, which ends every open session
+    QString name;
+    bool joined;
+};
+
+class PlayerStats
+{
+public:
+    QString xuid;
+    QString name;
+    qint64 playSeconds = 0; // Within the range asked for
+    int sessions = 0;
+    QDateTime firstSeen;
+    QDateTime lastSeen;
+};
+
+class PlayerAnalytics
+{
+public:
+    qint64 from = 0;
+    qint64 to = 0;
+    QList<PlayerStats> players; // Most play time first
+    QList<TimeSeriesPoint> hourly; // Average and peak players online for each hour
+    int quietestHour = -1; // Hour of the week, 0 is Monday 00:00 local time, -1 without a week of data
+    double quietestAverage = 0;
+};
+
+Q_DECLARE_METATYPE(SessionEvent)
+Q_DECLARE_METATYPE(PlayerAnalytics)
+
+// Owns the SQLite connection, on the store's thread.
+class SessionStoreWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SessionStoreWorker(QString fileName);
+
+public slots:
+    void start();
+    void writeEvents(QList<SessionEvent> events);
+    void analyse(qint64 from, qint64 to);
+    void totalPlayTimes();
+    void close();
+
+signals:
+    void analysisFinished(PlayerAnalytics analytics, qint64 elapsedNs);
+    void playTimesFinished(QHash<QString,qint64> seconds);
+
+private:
+    QString fileName;
+    QString connectionName;
+    qint64 longestSession; // Seconds, bounds how far before a range a session overlapping it can start
+    QTimer *heartbeatTimer;
+
+    void closeSessions(const QString &xuid, qint64 time); // Every open session if xuid is empty
+    void importMappings();
+    qint64 metaValue(const QString &key);
+    void setMetaValue(const QString &key, qint64 value);
+};
+
+// Records every player connect and disconnect in an SQLite database, and answers
+// playtime, first and last seen and players online by hour from it. Events are batched
+// and written in one transaction on a worker thread.
+class SessionStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SessionStore(BedrockServer *server, QObject *parent = nullptr);
+    ~SessionStore();
+
+    void analyse(QDateTime from, QDateTime to); // Results come via analysisFinished.
+    void totalPlayTimes(); // Seconds played by each xuid, ever, via playTimesFinished.
+
+public slots:
+    void flush();
+
+signals:
+    void writeEvents(QList<SessionEvent> events);
+    void analysisRequested(qint64 from, qint64 to);
+    void analysisFinished(PlayerAnalytics analytics, qint64 elapsedNs);
+    void playTimesRequested();
+    void playTimesFinished(QHash<QString,qint64> seconds);
+
+private:
+    BedrockServer *server;
+    QThread workerThread;
+    SessionStoreWorker *worker;
+    QList<SessionEvent> pending;
+    QTimer pendingTimer;
+
+    void append(QString xuid, QString name, bool joined);
+};
+
+#endif // SESSIONSTORE_H
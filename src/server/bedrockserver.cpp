@@ -18,21 +18,130 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QSaveFile>
+#include <QSet>
 #include <QDateTime>
 #include <QTextStream>
+#include <QSettings>
 
 #include <QDebug>
 
-BedrockServer::BedrockServer(QObject *parent) : QObject(parent),restartAfterStopped(false),tempDir(nullptr),state(ServerNotRunning),backupDelaySeconds(10),restartOnServerExit(true)
+#ifdef MCBC_PIPELINE_STATS
+#include <QElapsedTimer>
+
+class PipelineStageTimer {
+public:
+    PipelineStageTimer(qint64 &total) : total(total) { this->timer.start(); }
+    ~PipelineStageTimer() { this->total += this->timer.nsecsElapsed(); }
+private:
+    qint64 &total;
+    QElapsedTimer timer;
+};
+#define PIPELINE_STAGE(total) PipelineStageTimer stageTimer(this->stats.total)
+#else
+#define PIPELINE_STAGE(total)
+#endif
+
+BedrockServer::BedrockServer(QObject *parent) : QObject(parent),restartAfterStopped(false),tempDir(nullptr),state(ServerNotRunning),backupDelaySeconds(10),restartOnServerExit(true),backupCompressStartMs(0)
 {
     this->serverRootFolder = "";
     this->serverProcess = new QProcess();
     // Tell QProcess to sent everything to stdout
     this->serverProcess->setProcessChannelMode(QProcess::MergedChannels);
     this->backupDelayTimer.setSingleShot(true);
+    this->playerEventsTimer.setSingleShot(true);
+    this->playerEventsTimer.setInterval(0);
+    connect(&this->playerEventsTimer,&QTimer::timeout,this,[=]() {
+        emitStatusLine();
+        emit this->onlinePlayersChanged();
+    });
+
+    this->commandQueue = new CommandQueue(this);
+    this->commandQueue->setMaxCommandsPerSecond(QSettings().value("server/maxCommandsPerSecond",10).toInt());
+    connect(this->commandQueue,&CommandQueue::commandReady,this,[=](QString command) {
+        this->responsivenessProbe->commandWritten(command);
+        this->serverProcess->write(QString(command+"\n").toLocal8Bit());
+    });
+
+    this->outputThrottle = new OutputThrottle(this);
+    this->outputThrottle->setMaxLinesPerSecond(QSettings().value("console/floodLinesPerSecond",200).toInt());
+    connect(this->outputThrottle,&OutputThrottle::summary,this,[=](QString message) {
+        emit this->serverOutput(OutputType::WarningOutput,message);
+    });
+
+    this->responsivenessProbe = new ResponsivenessProbe(this);
+    connect(this->responsivenessProbe,&ResponsivenessProbe::probeDue,this,[=]() {
+        // Straight out, time spent in the queue would be counted as server lag.
+        this->commandQueue->enqueue(ResponsivenessProbe::probeCommand(),CommandQueue::Urgent);
+    });
+    connect(this->responsivenessProbe,&ResponsivenessProbe::slowChanged,this,[=](bool slow, qint64 p95Ms) {
+        if (slow) {
+            emit this->serverOutput(OutputType::WarningOutput,tr("The server is slow to respond, 95% of recent commands took up to %1 ms.").arg(p95Ms));
+        } else {
+            emit this->serverOutput(OutputType::InfoOutput,tr("The server is responding normally again."));
+        }
+        emitStatusLine();
+    });
+    connect(this->responsivenessProbe,&ResponsivenessProbe::stalled,this,[=](qint64 waitingMs) {
+        emit this->serverOutput(OutputType::WarningOutput,tr("The server hasn't answered a command for %1 seconds.").arg(waitingMs/1000));
+    });
+
+    this->configStore = new ServerConfigStore(this);
+    connect(this->configStore,&ServerConfigStore::changed,this,&BedrockServer::serverConfigurationUpdated);
+    connect(this->configStore,&ServerConfigStore::invalidValue,this,[=](QString name, QString problem) {
+        emit this->serverOutput(OutputType::WarningOutput,tr("server.properties: %1 %2.").arg(name,problem));
+    });
+
+    this->lifecycleTimeline = new LifecycleTimeline(this);
+    connect(this->lifecycleTimeline,&LifecycleTimeline::startTimed,this,[=](qint64, QString summary) {
+        emit this->serverOutput(OutputType::InfoOutput,summary);
+    });
+    connect(this->lifecycleTimeline,&LifecycleTimeline::stopTimed,this,[=](qint64, QString summary) {
+        emit this->serverOutput(OutputType::InfoOutput,summary);
+    });
+    connect(this->lifecycleTimeline,&LifecycleTimeline::regression,this,[=](QString message) {
+        emit this->serverOutput(OutputType::WarningOutput,message);
+    });
+
+    connect(this,&BedrockServer::backupFailed,this,[=]() {
+        this->backupTimings.failed = true;
+        emit this->backupTimingsUpdated();
+    });
+
+    this->responseParser = new ResponseParser(this);
+    connect(this->responseParser,&ResponseParser::permissionEntry,this,[=](QString xuid, QString permission) {
+        if (permission=="operator") {
+            this->responseOps.append(xuid);
+        } else if (permission=="member") {
+            this->responseMembers.append(xuid);
+        } else if (permission=="visitor") {
+            this->responseVisitors.append(xuid);
+        }
+    });
+    connect(this->responseParser,&ResponseParser::allowlistEntry,this,[=](QString name, bool ignoresPlayerLimit) {
+        this->responseAllowlist.append(QPair<QString,bool>(name,ignoresPlayerLimit));
+    });
+    connect(this->responseParser,&ResponseParser::operatorEntry,this,[=](QString xuid) {
+        this->responseXuids.append(xuid);
+    });
+    connect(this->responseParser,&ResponseParser::responseComplete,this,[=](QString command, bool valid) {
+        if (valid) {
+            processResponse(command);
+        }
+        this->responseOps.clear();
+        this->responseMembers.clear();
+        this->responseVisitors.clear();
+        this->responseXuids.clear();
+        this->responseAllowlist.clear();
+    });
 
     connect(this->serverProcess,&QProcess::readyReadStandardOutput,this,&BedrockServer::handleServerOutput);
     connect(this->serverProcess,&QProcess::stateChanged,this,[=](QProcess::ProcessState state) {
+        if (state==QProcess::NotRunning) {
+            // Nothing queued is any use to the next server process.
+            this->commandQueue->clear();
+            this->lifecycleTimeline->mark(LifecycleTimeline::Exited);
+        }
         if (state==QProcess::NotRunning && this->state==ServerShutdown) {
             setState(ServerStopped);
         }
@@ -115,6 +224,8 @@ void BedrockServer::startBackup()
 {
     this->backupScheduled=false;
     this->backupDelayTimer.stop();
+    this->backupTimings = BackupTimings();
+    this->backupClock.start();
     emit this->backupStarting();
     this->sendCommandToServer("save hold");
 }
@@ -152,10 +263,12 @@ void BedrockServer::actuallyStartServer()
         setState(ServerNotRunning);
         emit this->serverOutput(ErrorOutput,tr("Server root folder is not valid. Server can not start."));
     } else if (this->serverProcess->state()==QProcess::NotRunning) {
-        loadConfiguration();
+        this->configStore->reload();
         this->maximumPlayerCount = getConfigValue("max-players").toInt();
-        this->serverProcess->setProgram(this->serverRootFolder+"\\bedrock_server.exe");
+        this->serverProcess->setProgram(QDir(this->serverRootFolder).filePath(serverExecutableName()));
+        this->serverProcess->setWorkingDirectory(this->serverRootFolder);
         this->serverProcess->start();
+        this->lifecycleTimeline->mark(LifecycleTimeline::Spawned);
         setState(ServerLoading);
     }
 }
@@ -171,6 +284,7 @@ void BedrockServer::stopServer()
         }
         setState(ServerShutdown);
         sendCommandToServer("stop");
+        this->lifecycleTimeline->mark(LifecycleTimeline::StopSent);
     }
 }
 
@@ -182,7 +296,7 @@ void BedrockServer::stopAndRestartServer()
 
 void BedrockServer::sendCommandToServer(QString command)
 {
-    this->serverProcess->write(QString(command+"\n").toLocal8Bit());
+    this->commandQueue->enqueue(command);
 }
 
 void BedrockServer::setDifficulty(int difficulty)
@@ -251,6 +365,8 @@ void BedrockServer::processFinishedBackup()
    QString tempDirString = tempDir->path();
    qDebug() << "Temp dir: "<<tempDirString;
    QString worldName;
+   qint64 copyStartMs = this->backupClock.isValid() ? this->backupClock.elapsed() : 0;
+   this->backupTimings.prepareMs = copyStartMs;
    if (tempDir->isValid()) {
        while(!listOfFiles.isEmpty()) {
            QList<QString> file = listOfFiles.takeFirst().split(":");
@@ -281,6 +397,7 @@ void BedrockServer::processFinishedBackup()
            fileToCopy.copy(destinationFileName);
            // And make sure it's the correct size
            QFile::resize(destinationFileName,destinationSize);
+           this->backupTimings.copiedBytes += destinationSize;
        }
 
        // Now copy some config
@@ -294,14 +411,18 @@ void BedrockServer::processFinishedBackup()
        emit this->serverOutput(OutputType::InfoOutput,tr("Requesting the server resume normal operations."));
        sendCommandToServer("save resume");
        emit backupSavingData();
+       this->backupCompressStartMs = this->backupClock.isValid() ? this->backupClock.elapsed() : 0;
+       this->backupTimings.copyMs = this->backupCompressStartMs - copyStartMs;
+       emit backupTimingsUpdated();
 
        QProcess *zipper = new QProcess();
 
        QObject::connect(zipper,&QProcess::finished,this,&BedrockServer::handleZipComplete);
        QObject::connect(zipper,&QProcess::finished,zipper,&QObject::deleteLater);
 
-       zipper->setProgram("powershell");
        QStringList zipperArguments;
+#ifdef Q_OS_WIN
+       zipper->setProgram("powershell");
        zipperArguments <<"Compress-Archive"<<"-Path"<<"\""+tempDir->path()+"/worlds/\"";
 
        for(int x=0;x<otherFiles.size();x++) {
@@ -312,6 +433,18 @@ void BedrockServer::processFinishedBackup()
        }
 
        zipperArguments<<"-DestinationPath"<<"\""+tempDir->path()+"/backup.zip\"";
+#else
+       // No powershell, zip from inside the temp folder so the paths in the archive match.
+       zipper->setProgram("zip");
+       zipper->setWorkingDirectory(tempDir->path());
+       zipperArguments <<"-q"<<"-r"<<"backup.zip"<<"worlds";
+
+       for(int x=0;x<otherFiles.size();x++) {
+            if (QFileInfo(tempDir->path()+otherFiles[x]).exists()) {
+                zipperArguments << otherFiles[x].mid(1);
+            }
+       }
+#endif
        qDebug()<<"Zipper args: "<<zipperArguments;
        zipper->setArguments(zipperArguments);
        emit this->serverOutput(OutputType::InfoOutput,tr("Compressing the backup files."));
@@ -325,6 +458,7 @@ void BedrockServer::processFinishedBackup()
 
 void BedrockServer::parseOutputForEvents(QString output)
 {
+    PIPELINE_STAGE(eventsNs);
     if (output.contains("INFO] ")) {
         output = output.mid(output.indexOf("INFO] ")+6);
     }
@@ -336,13 +470,13 @@ void BedrockServer::parseOutputForEvents(QString output)
         QString xuid = player.second;
         QString name = player.first;
         emit this->playerConnected(name,xuid);
-        emitStatusLine();
+        this->playerEventsTimer.start();
     } else if (output.startsWith("Player disconnected: ")) {
         QPair<QString,QString> player = parsePlayerString(output.mid(21));
         QString xuid = player.second;
         QString name = player.first;
         emit this->playerDisconnected(name,xuid);
-        emitStatusLine();
+        this->playerEventsTimer.start();
         qDebug()<<"Player left: "<<parsePlayerString(output.mid(21));
     } else if (output.startsWith("De-opped:")) {
         sendCommandToServer("permission list");
@@ -369,6 +503,7 @@ void BedrockServer::setState(BedrockServer::ServerState newState)
                 .arg(stateName(newState));
         emit this->serverOutput(ServerStatus,statusString);
         this->state = newState;
+        this->responsivenessProbe->setActive(newState==ServerRunning);
         if (newState != ServerRunning) {
             this->backupDelayTimer.stop();
         }
@@ -384,59 +519,35 @@ bool BedrockServer::serverRootIsValid()
 {
     QDir serverRoot(this->serverRootFolder);
 
-    return (serverRoot.exists() && serverRoot.exists("bedrock_server.exe"));
+    return (serverRoot.exists() && serverRoot.exists(serverExecutableName()));
 }
 
-void BedrockServer::processResponseBuffer()
+void BedrockServer::processResponse(QString command)
 {
-    QJsonDocument doc = QJsonDocument::fromJson(this->responseBuffer.join("").toUtf8());
+    if (command=="permissions") {
+        emit this->serverPermissionList(this->responseOps,this->responseMembers,this->responseVisitors);
+    } else if (command=="whitelist" || command=="allowlist") {
+        QStringList whitelistedUsers;
 
-    if (doc.isObject()) {
-        QString command = doc.object().value("command").toString();
-
-        if (command=="permissions") {
-            QJsonArray permissions = doc.object().value("result").toArray();
-            QStringList ops,members,visitors;
-            for(int x=0;x<permissions.size();x++) {
-                QJsonObject permJson = permissions[x].toObject();
-                QString xuid = permJson.value("xuid").toString();
-                QString perm =  permJson.value("permission").toString();
-                if (perm=="operator") {
-                    ops.append(xuid);
-                } else if (perm=="member") {
-                    members.append(xuid);
-                } else if (perm=="visitor") {
-                    visitors.append(xuid);
-                }
-            }
-            emit this->serverPermissionList(ops,members,visitors);
-        } else if (command=="whitelist") {
-            QStringList whitelistedUsers;
-
-            QJsonArray results = doc.object().value("result").toArray();
-            emit this->serverOutput(OutputType::InfoOutput,tr("Server whitelist:"));
-            for(int x=0;x<results.size();x++) {
-                QJsonObject result = results[x].toObject();
-                QString name = result.value("name").toString();
-                bool ignoresPlayerLimit = result.value("ignoresPlayerLimit").toBool();
-                whitelistedUsers.append(name);
-                emit this->serverOutput(OutputType::InfoOutput,tr("%1 %2").arg(QString(name)).arg(ignoresPlayerLimit ? " [Ignores player limit]" : ""));
-            }
-            emit this->serverWhitelist(whitelistedUsers);
-        } else if (command=="ops") {
-            QJsonArray results = doc.object().value("result").toArray();
-            emit this->serverOutput(OutputType::InfoOutput,tr("Server operators:"));
-            for(int x=0;x<results.size();x++) {
-                QString xuid = results[x].toString();
-                QString name = getPlayerNameFromXuid(xuid);
-                if (name!=xuid) {
-                    name = name + " ["+xuid+"]";
-                }
-                emit this->serverOutput(OutputType::InfoOutput,QString(name));
+        emit this->serverOutput(OutputType::InfoOutput,tr("Server whitelist:"));
+        for(int x=0;x<this->responseAllowlist.size();x++) {
+            QString name = this->responseAllowlist[x].first;
+            bool ignoresPlayerLimit = this->responseAllowlist[x].second;
+            whitelistedUsers.append(name);
+            emit this->serverOutput(OutputType::InfoOutput,tr("%1 %2").arg(QString(name)).arg(ignoresPlayerLimit ? " [Ignores player limit]" : ""));
+        }
+        emit this->serverWhitelist(whitelistedUsers);
+    } else if (command=="ops") {
+        emit this->serverOutput(OutputType::InfoOutput,tr("Server operators:"));
+        for(int x=0;x<this->responseXuids.size();x++) {
+            QString xuid = this->responseXuids[x];
+            QString name = getPlayerNameFromXuid(xuid);
+            if (name!=xuid) {
+                name = name + " ["+xuid+"]";
             }
+            emit this->serverOutput(OutputType::InfoOutput,QString(name));
         }
     }
-    this->responseBuffer.clear();
 }
 
 void BedrockServer::emitStatusLine()
@@ -457,7 +568,8 @@ void BedrockServer::emitStatusLine()
         state = tr("Server is shutting down");
         break;
     case ServerRunning:
-        state = tr("Server is running normally");
+        state = this->responsivenessProbe->isSlow() ? tr("Server is running but slow to respond (%1 ms)").arg(this->responsivenessProbe->percentile(0.95))
+                                                    : tr("Server is running normally");
         online = true;
         break;
     default:
@@ -471,134 +583,22 @@ void BedrockServer::emitStatusLine()
     emit this->serverStatusLine(tr("%1%2","statusline").arg(state).arg(onlineCount));
 }
 
-void BedrockServer::loadConfiguration()
-{
-    QFile config(this->serverRootFolder+"/server.properties");
-
-    if (!(config.exists() && config.open(QIODevice::ReadOnly|QIODevice::Text))) {
-        return;
-    }
-
-    for(auto i=serverConfig.constBegin();i!=serverConfig.constEnd();i++) {
-        delete (*i);
-    }
-    serverConfig.clear();
-    serverConfigByName.clear();
-
-    QTextStream lines(&config);
-    ConfigEntry *entry=nullptr;
-
-    while (!lines.atEnd()) {
-        QString line = lines.readLine().trimmed();
-        if (line=="") {
-            continue;
-        }
-        if (line.startsWith('#') && entry) {
-            entry->help += line.mid(1).trimmed()+'\n';
-        } else if (line.contains('=')) {
-            if (entry) {
-                qDebug() << "Appending: " << entry->name << entry->value << entry->help;
-                this->serverConfig.append(entry);
-                this->serverConfigByName.insert(entry->name,entry);
-            }
-            entry = new ConfigEntry;
-
-            entry->name = line.left(line.indexOf('='));
-            QString value = line.mid(line.indexOf('=')+1);
-
-            switch (getTypeOfConfigValue(entry->name)) {
-                case String : entry->value = QVariant(value);break;
-                case Integer : entry->value = QVariant(value.toInt());break;
-                case Boolean : entry->value = QVariant(value == "true");break;
-                case Float : entry->value = QVariant(value.toDouble());break;
-            }
-
-            entry->possibleValues = getPossibleValues(entry->name);
-        }
-    }
-    if (entry) {
-        qDebug() << "Appending: " << entry->name << entry->value << entry->help;
-        this->serverConfig.append(entry);
-        this->serverConfigByName.insert(entry->name,entry);
-    }
-
-    config.close();
-}
-
-void BedrockServer::saveConfiguration()
+bool BedrockServer::saveConfiguration()
 {
     qDebug()<<"Saving configuration.";
 
     emit this->serverOutput(OutputType::InfoOutput,tr("Saving server configuration."));
-    QFile config(this->serverRootFolder+"/server.properties");
-
-    if (!(config.exists() && config.open(QIODevice::ReadWrite|QIODevice::Text))) {
-        return;
+    QString error;
+    if (!this->configStore->save(error)) {
+        emit this->serverOutput(OutputType::ErrorOutput,tr("Server configuration not saved: %1").arg(error));
+        return false;
     }
-
-    QTextStream lines(&config);
-    QStringList outputLines;
-
-    while (!lines.atEnd()) {
-        QString line = lines.readLine();
-
-        if (!line.startsWith('#') && line.contains('=')) {
-            QString name = line.left(line.indexOf('='));
-            if (serverConfigByName.contains(name)) {
-                ConfigEntry *entry = serverConfigByName.value(name);
-                if (!entry->newValue.isNull() && (entry->value.toString() != entry->newValue.toString())) {
-                    line = QString("%1=%2").arg(name).arg(entry->newValue.toString());
-                    entry->value = entry->newValue;
-                }
-            }
-        }
-        outputLines.append(line);
-    }
-
-    lines.seek(0);
-
-    while(!outputLines.isEmpty()) {
-        lines << outputLines.takeFirst() << "\n";
-    }
-
-    config.close();
-    emit this->serverConfigurationUpdated();
-}
-
-BedrockServer::ConfigValueType BedrockServer::getTypeOfConfigValue(QString name)
-{
-    if (QStringList({"server-authoritative-block-breaking","correct-player-movement","content-log-file-enabled","texturepack-required","white-list","online-mode","allow-cheats","force-gamemode"}).contains(name)) {
-        return BedrockServer::ConfigValueType::Boolean;
-    } else if (QStringList({"max-player","server-port","server-portv6","view-distance","tick-distance","player-idle-timeout","max-threads","compression-threshold","player-movement-score-threshold"}).contains(name)) {
-        return BedrockServer::ConfigValueType::Integer;
-    } else if (name=="player-movement-distance-threshold") {
-        return BedrockServer::ConfigValueType::Float;
-    }
-    return BedrockServer::ConfigValueType::String;
-}
-
-QStringList BedrockServer::getPossibleValues(QString name)
-{
-    if (name=="gamemode") {
-        return {"survival", "creative",  "adventure"};
-    } else if (name=="difficulty") {
-        return {"peaceful","easy","normal","hard"};
-    } else if (name=="default-player-permission-level") {
-        return {"visitor", "member", "operator"};
-    } else if (name=="server-authoritative-movement") {
-        return {"client-auth", "server-auth", "server-auth-with-rewind"};
-    }
-    return QStringList();
+    return true;
 }
 
 QVariant BedrockServer::getConfigValue(QString name)
 {
-    for(auto i=this->serverConfig.constBegin();i!=this->serverConfig.constEnd();i++) {
-        if ((*i)->name == name) {
-            return (*i)->value;
-        }
-    }
-    return QVariant();
+    return this->configStore->value(name);
 }
 
 QString BedrockServer::stateName(BedrockServer::ServerState state)
@@ -615,12 +615,22 @@ QString BedrockServer::stateName(BedrockServer::ServerState state)
     return "UNKNOWN";
 }
 
+QString BedrockServer::serverExecutableName()
+{
+#ifdef Q_OS_WIN
+    return "bedrock_server.exe";
+#else
+    return "bedrock_server";
+#endif
+}
+
 void BedrockServer::setServerRootFolder(QString folder)
 {
     if (folder!=this->serverRootFolder && QDir(folder).exists()) {
         // New location is valid.
         stopServer(); // Incase we have a current server and it's running.
         this->serverRootFolder = folder;
+        this->configStore->setFile(QDir(folder).filePath("server.properties"));
         qDebug()<<"Server root folder set to: "<<folder;
     }
 }
@@ -638,6 +648,37 @@ QAbstractItemModel *BedrockServer::getServerModel()
     return this->model;
 }
 
+CommandQueue *BedrockServer::getCommandQueue()
+{
+    return this->commandQueue;
+}
+
+OutputThrottle *BedrockServer::getOutputThrottle()
+{
+    return this->outputThrottle;
+}
+
+ResponsivenessProbe *BedrockServer::getResponsivenessProbe()
+{
+    return this->responsivenessProbe;
+}
+
+LifecycleTimeline *BedrockServer::getLifecycleTimeline()
+{
+    return this->lifecycleTimeline;
+}
+
+ServerConfigStore *BedrockServer::getConfigStore()
+{
+    return this->configStore;
+}
+
+void BedrockServer::setOutputFloodLinesPerSecond(int lines)
+{
+    QSettings().setValue("console/floodLinesPerSecond",lines);
+    this->outputThrottle->setMaxLinesPerSecond(lines);
+}
+
 QString BedrockServer::getXuidFromIndex(QModelIndex index)
 {
     return this->model->getXuidFromIndex(index);
@@ -658,54 +699,95 @@ int BedrockServer::getPermissionLevel(QString xuid)
     return this->model->getPermissionLevel(xuid);
 }
 
+int BedrockServer::onlinePlayerCount()
+{
+    return this->model->onlinePlayerCount();
+}
+
+int BedrockServer::onlineOperatorCount()
+{
+    return this->model->onlineOpCount();
+}
+
+quint64 BedrockServer::permissionRowChanges()
+{
+    return this->model->permissionRowChanges();
+}
+
 void BedrockServer::setPermissionLevelForUser(QString xuid, BedrockServer::PermissionLevel level)
 {
-    if (level==getPermissionLevel(xuid)) {
-        return;
+    PermissionChanges changes;
+    changes.levels.insert(xuid,level);
+    applyPermissionChanges(changes);
+}
+
+bool BedrockServer::applyPermissionChanges(const PermissionChanges &changes)
+{
+    QHash<QString,PermissionLevel> levels;
+    for(auto i=changes.levels.constBegin();i!=changes.levels.constEnd();i++) {
+        if (i.value()!=getPermissionLevel(i.key())) {
+            levels.insert(i.key(),i.value());
+        }
+    }
+    if (levels.isEmpty()) {
+        return true;
     }
 
-    QFile permissionsFile(QString("%1/permissions.json").arg(this->serverRootFolder));
+    QString fileName = QString("%1/permissions.json").arg(this->serverRootFolder);
+    QFile permissionsFile(fileName);
     if (!permissionsFile.open(QIODevice::ReadOnly)) {
-        return;
+        emit this->serverOutput(OutputType::ErrorOutput,tr("Can't read %1, permissions not changed.").arg(fileName));
+        return false;
     }
     QJsonDocument permJson = QJsonDocument::fromJson(permissionsFile.readAll());
     permissionsFile.close();
-
-    QString permString = level == 0 ? "member" : level == 1 ? "operator" : "Visitor";
-
-    if (permJson.isArray()) {
-        QJsonArray permissions = permJson.array();
-        bool updated = false;
-        for(int x=0;x<permissions.size();x++) {
-            QJsonObject permObj = permissions.at(x).toObject();
-            if (permObj.value("xuid").toString()==xuid) {
-                // Found person in permissions array
-                permObj["permission"]=permString;
-                updated=true;
-            }
+    if (!permJson.isArray()) {
+        emit this->serverOutput(OutputType::ErrorOutput,tr("%1 isn't a list of permissions, permissions not changed.").arg(fileName));
+        return false;
+    }
+
+    QJsonArray permissions = permJson.array();
+    QSet<QString> found;
+    for(int x=0;x<permissions.size();x++) {
+        QJsonObject permObj = permissions.at(x).toObject();
+        QString xuid = permObj.value("xuid").toString();
+        if (levels.contains(xuid)) {
+            // Found person in permissions array
+            permObj["permission"]=permissionName(levels.value(xuid));
             permissions[x]=permObj;
+            found.insert(xuid);
         }
-        if (!updated) {
+    }
+    for(auto i=levels.constBegin();i!=levels.constEnd();i++) {
+        if (!found.contains(i.key())) {
             QJsonObject newPerm;
-            newPerm.insert("permission",permString);
-            newPerm.insert("xuid",xuid);
+            newPerm.insert("permission",permissionName(i.value()));
+            newPerm.insert("xuid",i.key());
             permissions.append(newPerm);
         }
-        if (permissionsFile.open(QIODevice::WriteOnly)) {
-            permissionsFile.resize(0);
-            permJson.setArray(permissions);
-            permissionsFile.write(permJson.toJson());
-            permissionsFile.close();
-            qDebug()<< "Saved updated permissions file, sending reload to server";
-            sendCommandToServer("permission reload");
-            sendCommandToServer("permission list");
-        }
     }
+
+    // Written beside the original and renamed over it, the server never sees half a file.
+    QSaveFile out(fileName);
+    permJson.setArray(permissions);
+    if (!out.open(QIODevice::WriteOnly) || out.write(permJson.toJson())<0 || !out.commit()) {
+        emit this->serverOutput(OutputType::ErrorOutput,tr("Can't save %1, permissions not changed: %2").arg(fileName,out.errorString()));
+        return false;
+    }
+    qDebug()<< "Saved"<<levels.size()<<"permission changes, sending reload to server";
+    sendCommandToServer("permission reload");
+    sendCommandToServer("permission list");
+    return true;
+}
+
+QString BedrockServer::permissionName(PermissionLevel level)
+{
+    return level==Operator ? "operator" : level==Visitor ? "visitor" : "member";
 }
 
 QList<BedrockServer::ConfigEntry *> BedrockServer::serverConfiguration()
 {
-    return this->serverConfig;
+    return this->configStore->entries();
 }
 
 int BedrockServer::maxPlayers()
@@ -713,6 +795,15 @@ int BedrockServer::maxPlayers()
     return this->maximumPlayerCount;
 }
 
+QString BedrockServer::getWorldFolder()
+{
+    QString levelName = getConfigValue("level-name").toString();
+    if (this->serverRootFolder.isEmpty() || levelName.isEmpty()) {
+        return QString();
+    }
+    return QDir(this->serverRootFolder).filePath("worlds/"+levelName);
+}
+
 void BedrockServer::scheduleBackup()
 {
     if (this->backupDelayTimer.isActive()) {
@@ -729,14 +820,28 @@ void BedrockServer::scheduleBackup()
 
 void BedrockServer::handleServerOutput()
 {
-    QByteArray serverOutputData = this->serverProcess->readAll();
-    this->processOutputBuffer.append(serverOutputData);
+    processServerOutput(this->serverProcess->readAll());
+}
+
+void BedrockServer::processServerOutput(const QByteArray &data)
+{
+    PIPELINE_STAGE(outputNs);
+    this->processOutputBuffer.append(data);
 
     while(canReadServerLine()) {
         QString line = readServerLine();
+#ifdef MCBC_PIPELINE_STATS
+        this->stats.lines++;
+#endif
         QString cleanLine = cleanServerLine(line);
+        this->lifecycleTimeline->serverLine(line);
 
         if (cleanLine=="Saving...") {
+            if (!this->backupClock.isValid() || this->backupTimings.failed || this->backupTimings.totalMs>=0) {
+                // Not started by startBackup, eg. 'save hold' typed in the console.
+                this->backupTimings = BackupTimings();
+                this->backupClock.start();
+            }
             emit backupStarting();
             emit this->serverOutput(OutputType::InfoOutput,tr("Server is preparing for the world files to be copied."));
             this->processRunningBackup();
@@ -750,29 +855,58 @@ void BedrockServer::handleServerOutput()
             this->processFinishedBackup();
         } else if (cleanLine=="Changes to the level are resumed.") {
             emit this->serverOutput(OutputType::InfoOutput,tr("The server has resumed normal operations."));
+            if (this->backupClock.isValid()) {
+                this->backupTimings.holdWindowMs = this->backupClock.elapsed();
+                emit backupTimingsUpdated();
+            }
             emit backupFinishedOnServer();
         } else if (line.contains("Difficulty: ") && this->state==ServerStartup) {
             QString difficulty = line.mid(line.indexOf("Difficulty: ")+12,1);
             this->difficulty=(ServerDifficulty)difficulty.toInt();
             emit this->serverDifficulty(this->difficulty);
-        } else if (line.startsWith("###* ")) {
-            this->responseBuffer.clear();
-            this->responseBuffer.append(line.mid(5));
-        } else if (line==" *###") {
-            processResponseBuffer();
+        } else if (this->responsivenessProbe->handleLine(line,cleanLine)) {
+            // Answer to a responsiveness probe
+        } else if (handleResponseLine(line)) {
+            // Consumed by the response parser
         } else {
-            emit this->serverOutput(OutputType::ServerInfoOutput,line);
+            emit this->serverLogLine(OutputType::ServerInfoOutput,line);
+            if (this->outputThrottle->admit(line)) {
+                emit this->serverOutput(OutputType::ServerInfoOutput,line);
+            }
             parseOutputForEvents(line);
         }
     }
 }
 
+bool BedrockServer::handleResponseLine(const QString &line)
+{
+    PIPELINE_STAGE(responseNs);
+    if (line.startsWith("###* ")) {
+        this->responseParser->begin();
+        this->responseParser->feed(QStringView(line).mid(5));
+    } else if (line==" *###") {
+        this->responseParser->end();
+    } else if (this->responseParser->isActive()) {
+        // Part of a multi-line response
+        this->responseParser->feed(line);
+    } else {
+        return false;
+    }
+    return true;
+}
+
 void BedrockServer::handleZipComplete()
 {
     qDebug() << "File zipped up.";
     QFileInfo  zipFile(this->tempDir->path()+"/backup.zip");
 
     if (zipFile.exists()) {
+        if (this->backupClock.isValid()) {
+            this->backupTimings.totalMs = this->backupClock.elapsed();
+            this->backupTimings.compressMs = this->backupTimings.totalMs - this->backupCompressStartMs;
+            this->backupTimings.zipBytes = zipFile.size();
+            emit backupTimingsUpdated();
+        }
         emit this->serverOutput(OutputType::InfoOutput,tr("Backup complete."));
         emit this->backupFinished(zipFile.canonicalFilePath());
     } else {
@@ -791,6 +925,26 @@ int BedrockServer::pendingShutdownSeconds()
     return -1;
 }
 
+BedrockServer::BackupTimings BedrockServer::getLastBackupTimings()
+{
+    return this->backupTimings;
+}
+
+qint64 BedrockServer::getServerProcessId()
+{
+    if (this->serverProcess->state()==QProcess::NotRunning) {
+        return 0;
+    }
+    return this->serverProcess->processId();
+}
+
+#ifdef MCBC_PIPELINE_STATS
+BedrockServer::PipelineStats BedrockServer::pipelineStats()
+{
+    return this->stats;
+}
+#endif
+
 void BedrockServer::abortPendingShutdown()
 {
     this->startTimer.stop();
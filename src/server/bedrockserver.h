@@ -17,8 +17,16 @@
 #include <QProcess>
 #include <QTemporaryDir>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QAbstractItemModel>
 #include <QStandardItemModel>
+#include <QHash>
+#include <server/commandqueue.h>
+#include <server/responseparser.h>
+#include <server/outputthrottle.h>
+#include <server/responsivenessprobe.h>
+#include <server/lifecycletimeline.h>
+#include <server/serverconfigstore.h>
 
 class BedrockServerModel;
 
@@ -33,34 +41,74 @@ public:
     enum ServerDifficulty { Peacefull,Easy,Normal,Hard };
     enum PermissionLevel { Member,Operator,Visitor };
 
-    class ConfigEntry {
+    typedef ServerConfigStore::Entry ConfigEntry;
+
+    // Permission changes to make together, in one write of permissions.json and one reload.
+    class PermissionChanges {
+    public:
+        QHash<QString,PermissionLevel> levels; // xuid to its new level
+    };
+
+    // How long each part of the last backup took, in ms. -1 for any part that hasn't happened (yet).
+    class BackupTimings {
     public:
-        QString name;
-        QVariant value;
-        QVariant newValue;
-        QStringList possibleValues;
-        QString help;
+        qint64 prepareMs = -1;    // 'save hold' sent until the files were ready to copy
+        qint64 copyMs = -1;       // Copying the world files while saves are held
+        qint64 holdWindowMs = -1; // 'save hold' sent until the server said changes had resumed
+        qint64 compressMs = -1;
+        qint64 totalMs = -1;
+        qint64 copiedBytes = 0;
+        qint64 zipBytes = 0;
+        bool failed = false;
     };
 
     QString GetCurrentStateName();
     ServerState GetCurrentState();
     QString stateName(ServerState state);
+    static QString serverExecutableName();
     void setServerRootFolder(QString folder);
     void setBackupDelaySeconds(int seconds);
     QAbstractItemModel *getServerModel();
+    CommandQueue *getCommandQueue();
+    OutputThrottle *getOutputThrottle();
+    ResponsivenessProbe *getResponsivenessProbe();
+    LifecycleTimeline *getLifecycleTimeline();
+    ServerConfigStore *getConfigStore();
+    void setOutputFloodLinesPerSecond(int lines);
     QString getXuidFromIndex(QModelIndex index);
     QString getPlayerNameFromXuid(QString xuid);
     bool isOnline(QString xuid);
     int getPermissionLevel(QString xuid);
+    int onlinePlayerCount();
+    int onlineOperatorCount();
+    quint64 permissionRowChanges();
     void setPermissionLevelForUser(QString xuid, PermissionLevel level);
+    bool applyPermissionChanges(const PermissionChanges &changes); // All or nothing, false if permissions.json couldn't be changed
     QList<BedrockServer::ConfigEntry*> serverConfiguration();
     int maxPlayers();
+    QString getWorldFolder(); // Empty until server.properties has been read
     int pendingShutdownSeconds();
+    qint64 getServerProcessId(); // 0 when the server isn't running
+    BackupTimings getLastBackupTimings();
     void abortPendingShutdown();
+    void processServerOutput(const QByteArray &data); // Raw server stdout, also used to replay captured logs.
+
+#ifdef MCBC_PIPELINE_STATS
+    // Time spent in each stage of the output pipeline, only built into the benchmark tool.
+    class PipelineStats {
+    public:
+        quint64 lines = 0;
+        qint64 outputNs = 0; // Everything, including the stages below.
+        qint64 eventsNs = 0;
+        qint64 responseNs = 0;
+    };
+    PipelineStats pipelineStats();
+#endif
 signals:
     void serverStateChanged(BedrockServer::ServerState newState);
 
     void serverOutput(BedrockServer::OutputType type, QString outputLine);
+    void serverLogLine(BedrockServer::OutputType type, QString outputLine); // Every plain server line, including ones the flood throttle holds back.
     void backupStarting();   // A request has been made to start a backup
     void backupStarted();    // A command has been sent to start the backup and the server has started it
     void backupInProgres();  // The server is still doing stuff
@@ -69,9 +117,11 @@ signals:
     void backupFailed(); // The backup failed for some reason.
     void backupFinished(QString zipFilePath); // The backup has been complete and the zip file is ready.
     void backupComplete(); // All done. (The temp file is deleted after this).
+    void backupTimingsUpdated(); // Another phase of the current backup has finished, see getLastBackupTimings.
 
     void playerConnected(QString name, QString xuid);
     void playerDisconnected(QString name, QString xuid);
+    void onlinePlayersChanged(); // Once per event loop turn however many players joined or left in it
 
     void serverDifficulty(ServerDifficulty difficulty);
     void serverPermissionList(QStringList ops, QStringList members, QStringList visitors);
@@ -95,19 +145,25 @@ public slots:
     void stopAndRestartServer();
     void sendCommandToServer(QString command);
     void setDifficulty(int difficulty);
-    void saveConfiguration();
+    bool saveConfiguration(); // False if a value is invalid or the file couldn't be written
 //    void StopServer();
 
 private:
-    enum ConfigValueType { String,Integer,Float,Boolean };
-
     BedrockServerModel *model;
+    CommandQueue *commandQueue;
+    OutputThrottle *outputThrottle;
+    ResponsivenessProbe *responsivenessProbe;
+    LifecycleTimeline *lifecycleTimeline;
     QStandardItem *onlinePlayers;
     QStandardItem *operators;
     ServerDifficulty difficulty;
-    QStringList responseBuffer;
-    QList<ConfigEntry*> serverConfig;
-    QMap<QString,ConfigEntry*> serverConfigByName;
+    ResponseParser *responseParser;
+    QStringList responseOps; // Entries collected while a response is parsed
+    QStringList responseMembers;
+    QStringList responseVisitors;
+    QStringList responseXuids;
+    QList<QPair<QString,bool>> responseAllowlist;
+    ServerConfigStore *configStore;
 
     QString serverRootFolder;
     QProcess *serverProcess;
@@ -118,10 +174,14 @@ private:
     QTimer shutdownPendingTimer;
     QTimer shutdownHeartbeatTimer;
     QTimer backupDelayTimer; // if running
+    QTimer playerEventsTimer; // Zero length, so a storm of joins gets one status line
     int backupDelaySeconds; // Automated or triggered backups will wait at least this seconds between firing.
     int maximumPlayerCount; // Read from config.
     bool backupScheduled; // set true to do a backup
     bool restartOnServerExit; // if true then unless the stop server method has been called the server will be kept running.
+    QElapsedTimer backupClock; // Started when 'save hold' is sent
+    qint64 backupCompressStartMs;
+    BackupTimings backupTimings;
 
     void actuallyStartServer(); // Does the server startup
     QString readServerLine();
@@ -134,13 +194,15 @@ private:
     QPair<QString,QString> parsePlayerString(QString playerString);
     void setState(ServerState newState);
     bool serverRootIsValid();
-    void processResponseBuffer();
+    void processResponse(QString command);
     void emitStatusLine();
-    void loadConfiguration();
-    ConfigValueType getTypeOfConfigValue(QString name);
-    QStringList getPossibleValues(QString name);
     QVariant getConfigValue(QString name);
+    static QString permissionName(PermissionLevel level); // As permissions.json spells it
     bool restartAfterStopped;
+#ifdef MCBC_PIPELINE_STATS
+    PipelineStats stats;
+#endif
+    bool handleResponseLine(const QString &line);
 
 private slots:
     void handleServerOutput();
@@ -1,9 +1,9 @@
 #include "bedrockservermodel.h"
 #include <QFileIconProvider>
 #include <QModelIndex>
-#include <QSettings>
 #include <QDateTime>
 #include <QAbstractFileIconProvider>
+#include <QDebug>
 
 #define ONLINE_ROOT 1
 #define ONLINE_USER 2
@@ -14,9 +14,16 @@
 #define VISITORS_ROOT 7
 #define VISITORS_USER 8
 
+// Each branch has an odd root id and the next even id for its players.
+#define BRANCH_OF(id) (((int)(id)-1)/2)
+#define IS_ROOT(id) ((id)%2==1)
+
+#define BRANCH_FETCH_ROWS 1000 // Rows a branch shows at first, and adds each time the view scrolls to the end
+
 BedrockServerModel::BedrockServerModel(BedrockServer *parent)
-    : QAbstractItemModel(parent),server(parent)
+    : QAbstractItemModel(parent),server(parent),mappings(PlayerMappings::defaultFolder()),permissionRowsChanged(0),exposed{0,0,0,0},namesChanged(false)
 {
+    this->registry.setMappings(&this->mappings);
     //this->operators->appendRow(new QStandardItem(QFileIconProvider().icon(QAbstractFileIconProvider::Computer), tr("APerson")));
     //this->operators->appendRow(new QStandardItem(QFileIconProvider().icon(QAbstractFileIconProvider::Computer), tr("AnotherPerson")));
 
@@ -24,82 +31,59 @@ BedrockServerModel::BedrockServerModel(BedrockServer *parent)
     this->opsRoot = createIndex(2,0,(quintptr)OPS_ROOT);
     this->membersRoot = createIndex(1,0,(quintptr)MEMBERS_ROOT);
     this->visitorsRoot = createIndex(3,0,(quintptr)VISITORS_ROOT);
+    this->branchLabels[BRANCH_OF(ONLINE_ROOT)] = tr("Online players");
+    this->branchLabels[BRANCH_OF(MEMBERS_ROOT)] = tr("Members");
+    this->branchLabels[BRANCH_OF(OPS_ROOT)] = tr("Operators");
+    this->branchLabels[BRANCH_OF(VISITORS_ROOT)] = tr("Visitors");
+
+    connect(this,&QAbstractItemModel::rowsInserted,this,[=](const QModelIndex &parent) {
+        invalidateDisplay(parent);
+    });
+    connect(this,&QAbstractItemModel::rowsRemoved,this,[=](const QModelIndex &parent) {
+        invalidateDisplay(parent);
+    });
+    connect(this,&QAbstractItemModel::rowsMoved,this,[=](const QModelIndex &parent, int, int, const QModelIndex &destination) {
+        invalidateDisplay(parent);
+        invalidateDisplay(destination);
+    });
 
     connect(this->server,&BedrockServer::serverStateChanged,this,[=](BedrockServer::ServerState state) {
        if (state==BedrockServer::ServerRunning) {
            this->server->sendCommandToServer("permission list");
        } else {
+           flushPlayerEvents();
            if (!this->onlineUsers.isEmpty()) {
-               this->beginRemoveRows(this->onlineRoot,0,this->onlineUsers.size()-1);
-               this->onlineUsers.clear();
-               this->endRemoveRows();
+               for(int x=0;x<this->onlineUsers.size();x++) {
+                   QString xuid = this->onlineUsers.at(x);
+                   this->registry.setOnline(xuid,false);
+                   this->mappings.record(xuid,this->registry.name(xuid),QDateTime::currentDateTimeUtc());
+               }
+               removeBranchRows(this->onlineRoot,this->onlineUsers,0,this->onlineUsers.size()-1);
            }
        }
     });
+    // Joins and leaves update the registry straight away, the rows follow once per event
+    // loop turn so a server full of players reconnecting is one insert.
+    this->playerEventsTimer.setSingleShot(true);
+    this->playerEventsTimer.setInterval(0);
+    connect(&this->playerEventsTimer,&QTimer::timeout,this,&BedrockServerModel::flushPlayerEvents);
     connect(this->server,&BedrockServer::playerConnected,this,[=](QString name, QString xuid) {
-       if (!this->onlineUsers.contains(xuid)) {
-           this->beginInsertRows(this->onlineRoot,this->onlineUsers.size(),this->onlineUsers.size());
-           this->onlineUsers.append(xuid);
-           this->endInsertRows();
-       }
-       if (!this->xuidToGamertag.contains(xuid)) {
-           this->xuidToGamertag.insert(xuid,QPair<QString,QDateTime>(name,QDateTime::currentDateTimeUtc()));
+       updatePlayerName(xuid,name);
+       if (!this->registry.isOnline(xuid)) {
+           this->registry.setOnline(xuid,true);
+           this->pendingJoins.append(xuid);
        }
+       this->playerEventsTimer.start();
     });
     connect(this->server,&BedrockServer::playerDisconnected,this,[=](QString name, QString xuid) {
-       if (this->onlineUsers.contains(xuid)) {
-           int idx = this->onlineUsers.indexOf(xuid);
-           this->beginRemoveRows(this->onlineRoot,idx,idx);
-           this->onlineUsers.removeOne(xuid);
-           this->endRemoveRows();
-       }
-       if (this->xuidToGamertag.contains(xuid)) {
-           this->xuidToGamertag.remove(xuid);
-       }
-       this->xuidToGamertag.insert(xuid,QPair<QString,QDateTime>(name,QDateTime::currentDateTimeUtc()));
+       this->registry.setOnline(xuid,false);
+       updatePlayerName(xuid,name);
+       this->playerEventsTimer.start();
     });
     connect(this->server,&BedrockServer::serverPermissionList,this,[=](QStringList ops, QStringList members, QStringList visitors) {
         // Handle updated permissions
-        if (!this->opsByXuid.isEmpty()) {
-            this->beginRemoveRows(this->opsRoot,0,this->opsByXuid.size()-1);
-            this->opsByXuid.clear();
-            this->endRemoveRows();
-        }
-        if (!ops.isEmpty()) {
-            this->beginInsertRows(this->opsRoot,0,ops.size()-1);
-            this->opsByXuid.append(ops);
-            this->endInsertRows();
-        }
-
-        if (!this->membersByXuid.isEmpty()) {
-            this->beginRemoveRows(this->membersRoot,0,this->membersByXuid.size()-1);
-            this->membersByXuid.clear();
-            this->endRemoveRows();
-        }
-        if (!members.isEmpty()) {
-            this->beginInsertRows(this->membersRoot,0,members.size()-1);
-            this->membersByXuid.append(members);
-            this->endInsertRows();
-        }
-
-        if (!this->visitorsByXuid.isEmpty()) {
-            this->beginRemoveRows(this->visitorsRoot,0,this->visitorsByXuid.size()-1);
-            this->visitorsByXuid.clear();
-            this->endRemoveRows();
-        }
-        if (!visitors.isEmpty()) {
-            this->beginInsertRows(this->visitorsRoot,0,visitors.size()-1);
-            this->visitorsByXuid.append(visitors);
-            this->endInsertRows();
-        }
-        emit this->serverPermissionsChanged();
+        updatePermissions(ops,members,visitors);
     });
-    loadUserMappings();
-}
-
-BedrockServerModel::~BedrockServerModel()
-{
-    saveUserMappings();
 }
 
 QVariant BedrockServerModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -126,6 +110,19 @@ QModelIndex BedrockServerModel::index(int row, int column, const QModelIndex &pa
     } else if (parent.internalId()==VISITORS_ROOT) {
         return createIndex(row,column,(quintptr)VISITORS_USER);
     }
+    return QModelIndex();
+}
+
+BedrockServerModel::~BedrockServerModel()
+{
+    // Anyone still online when the console exits was last seen now, not when they joined.
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<QString> online = this->onlineUsers+this->pendingJoins;
+    for(int x=0;x<online.size();x++) {
+        if (this->registry.isOnline(online.at(x))) {
+            this->mappings.record(online.at(x),this->registry.name(online.at(x)),now);
+        }
+    }
 }
 
 QModelIndex BedrockServerModel::parent(const QModelIndex &index) const
@@ -144,13 +141,33 @@ int BedrockServerModel::rowCount(const QModelIndex &parent) const
     if (!parent.isValid())
         return 4;
 
-    switch(parent.internalId()) {
-    case ONLINE_ROOT : return this->onlineUsers.count();
-    case MEMBERS_ROOT : return this->membersByXuid.count();
-    case OPS_ROOT : return this->opsByXuid.count();
-    case VISITORS_ROOT : return this->visitorsByXuid.count();
-    }
-    return 0;
+    if (!IS_ROOT(parent.internalId()))
+        return 0;
+    return this->exposed[BRANCH_OF(parent.internalId())];
+}
+
+bool BedrockServerModel::hasChildren(const QModelIndex &parent) const
+{
+    return !parent.isValid() || (IS_ROOT(parent.internalId()) && !rowsForBranch(BRANCH_OF(parent.internalId())).isEmpty());
+}
+
+bool BedrockServerModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid() || !IS_ROOT(parent.internalId()))
+        return false;
+    int branch = BRANCH_OF(parent.internalId());
+    return this->exposed[branch]<rowsForBranch(branch).size();
+}
+
+void BedrockServerModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+    int branch = BRANCH_OF(parent.internalId());
+    int more = qMin(BRANCH_FETCH_ROWS,(int)rowsForBranch(branch).size()-this->exposed[branch]);
+    this->beginInsertRows(parent,this->exposed[branch],this->exposed[branch]+more-1);
+    this->exposed[branch] += more;
+    this->endInsertRows();
 }
 
 int BedrockServerModel::columnCount(const QModelIndex &parent) const
@@ -163,44 +180,121 @@ int BedrockServerModel::columnCount(const QModelIndex &parent) const
 
 QVariant BedrockServerModel::data(const QModelIndex &index, int role) const
 {
-    if (!index.isValid())
+    // Views ask for many roles per row on every repaint, so everything here comes from caches.
+    if (!index.isValid() || (role!=Qt::DisplayRole && role!=Qt::DecorationRole && role<XuidRole))
         return QVariant();
 
-    if (index.internalId()==ONLINE_ROOT) {
-        return (role==Qt::DisplayRole) ? QVariant("Online players") :
-               (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Folder) :
-               QVariant() ;
-    } else if (index.internalId()==MEMBERS_ROOT) {
-            return (role==Qt::DisplayRole) ? QVariant("Members") :
-                   (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Folder) :
-                   QVariant() ;
-    } else if (index.internalId()==OPS_ROOT) {
-            return (role==Qt::DisplayRole) ? QVariant("Operators") :
-                   (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Folder) :
-                   QVariant() ;
-    } else if (index.internalId()==VISITORS_ROOT) {
-            return (role==Qt::DisplayRole) ? QVariant("Visitors") :
-                   (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Folder) :
-                   QVariant() ;
-    } else if (index.parent().isValid() && index.parent().internalId()==ONLINE_ROOT) {
-        return (role==Qt::DisplayRole) ? QVariant(this->xuidToName(this->onlineUsers.at(index.row()))) :
-                                         (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Computer) :
-                                         QVariant() ;
-    } else if (index.parent().isValid() && index.parent().internalId()==MEMBERS_ROOT) {
-        return (role==Qt::DisplayRole) ? QVariant(this->xuidToName(this->membersByXuid.at(index.row()))) :
-                                         (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Computer) :
-                                         QVariant() ;
-    } else if (index.parent().isValid() && index.parent().internalId()==OPS_ROOT) {
-        return (role==Qt::DisplayRole) ? QVariant(this->xuidToName(this->opsByXuid.at(index.row()))) :
-                                         (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Computer) :
-                                         QVariant() ;
-    } else if (index.parent().isValid() && index.parent().internalId()==VISITORS_ROOT) {
-        return (role==Qt::DisplayRole) ? QVariant(this->xuidToName(this->visitorsByXuid.at(index.row()))) :
-                                         (role==Qt::DecorationRole) ? QFileIconProvider().icon(QAbstractFileIconProvider::Computer) :
-                                         QVariant() ;
+    int branch = BRANCH_OF(index.internalId());
+    if (IS_ROOT(index.internalId())) {
+        if (role>=XuidRole) {
+            return QVariant();
+        }
+        if (role==Qt::DisplayRole) {
+            return this->branchLabels[branch];
+        }
+        if (this->folderIcon.isNull()) {
+            this->folderIcon = QFileIconProvider().icon(QAbstractFileIconProvider::Folder);
+        }
+        return this->folderIcon;
     }
 
-    return QVariant();
+    if (role==Qt::DecorationRole) {
+        if (this->playerIcon.isNull()) {
+            this->playerIcon = QFileIconProvider().icon(QAbstractFileIconProvider::Computer);
+        }
+        return this->playerIcon;
+    }
+    const QList<QString> &rows = rowsForBranch(branch);
+    if (index.row()>=rows.size()) {
+        return QVariant();
+    }
+    if (role>=XuidRole) {
+        const QString &xuid = rows.at(index.row());
+        PlayerMappings::Mapping mapping;
+        return (role==XuidRole) ? QVariant(xuid) :
+               (role==PermissionRole) ? QVariant(this->registry.permission(xuid)) :
+               (role==LastSeenRole && this->registry.isOnline(xuid)) ? QVariant(QDateTime::currentDateTimeUtc()) :
+               (role==LastSeenRole && this->mappings.find(xuid,mapping)) ? QVariant(mapping.lastSeen) :
+               QVariant();
+    }
+    QList<QVariant> &cache = this->displayCache[branch];
+    if (cache.size()!=rows.size()) {
+        cache.clear();
+        cache.resize(rows.size());
+    }
+    QVariant &display = cache[index.row()];
+    if (!display.isValid()) {
+        display = this->registry.name(rows.at(index.row()));
+    }
+    return display;
+}
+
+const QList<QString> &BedrockServerModel::rowsForBranch(int branch) const
+{
+    switch (branch) {
+    case BRANCH_OF(ONLINE_ROOT) : return this->onlineUsers;
+    case BRANCH_OF(OPS_ROOT) : return this->opsByXuid;
+    case BRANCH_OF(MEMBERS_ROOT) : return this->membersByXuid;
+    default : return this->visitorsByXuid;
+    }
+}
+
+void BedrockServerModel::invalidateDisplay(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        this->displayCache[BRANCH_OF(parent.internalId())].clear();
+    }
+}
+
+void BedrockServerModel::updatePlayerName(const QString &xuid, const QString &name)
+{
+    this->namesChanged = this->namesChanged || this->registry.name(xuid)!=name;
+    this->registry.setName(xuid,name);
+    this->mappings.record(xuid,name,QDateTime::currentDateTimeUtc());
+}
+
+void BedrockServerModel::flushPlayerEvents()
+{
+    this->playerEventsTimer.stop();
+
+    // Leavers, removed in runs from the bottom.
+    for(int row=this->onlineUsers.size()-1;row>=0;) {
+        if (this->registry.isOnline(this->onlineUsers.at(row))) {
+            row--;
+            continue;
+        }
+        int last = row;
+        while (row>=0 && !this->registry.isOnline(this->onlineUsers.at(row))) {
+            row--;
+        }
+        removeBranchRows(this->onlineRoot,this->onlineUsers,row+1,last);
+    }
+    // Joiners still here, in the order they arrived. The online list is bounded by max-players.
+    QList<QString> joined;
+    for(int x=0;x<this->pendingJoins.size();x++) {
+        const QString &xuid = this->pendingJoins.at(x);
+        if (this->registry.isOnline(xuid) && !joined.contains(xuid) && !this->onlineUsers.contains(xuid)) {
+            joined.append(xuid);
+        }
+    }
+    this->pendingJoins.clear();
+    if (!joined.isEmpty()) {
+        appendBranchRows(this->onlineRoot,this->onlineUsers,joined);
+    }
+
+    if (!this->namesChanged) {
+        return;
+    }
+    this->namesChanged = false;
+    // Rare, a new gamertag or a player seen for the first time, so just redo every branch.
+    const QModelIndex roots[] = { this->onlineRoot,this->opsRoot,this->membersRoot,this->visitorsRoot };
+    for(const QModelIndex &root : roots) {
+        int rows = this->exposed[BRANCH_OF(root.internalId())];
+        invalidateDisplay(root);
+        if (rows>0) {
+            emit dataChanged(index(0,0,root),index(rows-1,0,root),{Qt::DisplayRole});
+        }
+    }
 }
 
 QString BedrockServerModel::getXuidFromIndex(QModelIndex index)
@@ -216,90 +310,178 @@ QString BedrockServerModel::getXuidFromIndex(QModelIndex index)
 
 QString BedrockServerModel::getPlayerNameFromXuid(QString xuid)
 {
-    if (this->xuidToGamertag.contains(xuid)) {
-        return this->xuidToGamertag.value(xuid).first;
-    }
-    return xuid;
+    return this->registry.name(xuid);
 }
 
 bool BedrockServerModel::isOnline(QString xuid)
 {
-    return this->onlineUsers.contains(xuid);
+    return this->registry.isOnline(xuid);
 }
 
 int BedrockServerModel::getPermissionLevel(QString xuid)
 {
-    if (this->membersByXuid.contains(xuid)) {
-        return 0;
-    } else if (this->opsByXuid.contains(xuid)) {
-        return 1;
-    } else if (this->visitorsByXuid.contains(xuid)) {
-        return 2;
-    }
-    return -1;
+    return this->registry.permission(xuid);
 }
 
 int BedrockServerModel::onlinePlayerCount()
 {
-    return this->onlineUsers.size();
+    return this->registry.onlineCount();
 }
 
 int BedrockServerModel::onlineOpCount()
 {
-    int count=0;
-    for(auto x=this->onlineUsers.constBegin();x!=this->onlineUsers.constEnd();x++) {
-        QString user = (*x);
-        if (getPermissionLevel(user)==BedrockServer::Operator) {
-            count++;
-        }
+    return this->registry.onlineOperatorCount();
+}
+
+quint64 BedrockServerModel::permissionRowChanges()
+{
+    return this->permissionRowsChanged;
+}
+
+QList<QString> &BedrockServerModel::rowsForPermission(int permission)
+{
+    switch (permission) {
+    case BedrockServer::Operator : return this->opsByXuid;
+    case BedrockServer::Visitor : return this->visitorsByXuid;
+    default : return this->membersByXuid;
     }
-    return count;
 }
 
-QString BedrockServerModel::xuidToName(QString xuid) const
+QModelIndex BedrockServerModel::rootForPermission(int permission)
 {
-    if (this->xuidToGamertag.contains(xuid)) {
-        return this->xuidToGamertag.value(xuid).first;
+    switch (permission) {
+    case BedrockServer::Operator : return this->opsRoot;
+    case BedrockServer::Visitor : return this->visitorsRoot;
+    default : return this->membersRoot;
     }
-    return xuid;
 }
 
-void BedrockServerModel::saveUserMappings()
+void BedrockServerModel::updatePermissions(const QStringList &ops, const QStringList &members, const QStringList &visitors)
 {
-    QSettings opts;
+    // Only rows that changed are touched, so an unchanged list costs nothing in the views
+    // and selection and expansion survive a refresh.
+    const int levels[] = { BedrockServer::Operator,BedrockServer::Member,BedrockServer::Visitor };
+    const QStringList *lists[] = { &ops,&members,&visitors };
+    QHash<QString,int> wanted;
+    wanted.reserve(ops.size()+members.size()+visitors.size());
+    for(int x=0;x<3;x++) {
+        for(int y=0;y<lists[x]->size();y++) {
+            if (!wanted.contains(lists[x]->at(y))) {
+                wanted.insert(lists[x]->at(y),levels[x]);
+            }
+        }
+    }
+    int changes = 0;
 
-    opts.beginGroup("users");
-    opts.beginWriteArray("mappings");
+    // Gone, removed in runs from the bottom so earlier rows keep their numbers.
+    for(int level : levels) {
+        QList<QString> &rows = rowsForPermission(level);
+        for(int row=rows.size()-1;row>=0;) {
+            if (wanted.contains(rows.at(row))) {
+                row--;
+                continue;
+            }
+            int last = row;
+            while (row>=0 && !wanted.contains(rows.at(row))) {
+                row--;
+            }
+            for(int x=row+1;x<=last;x++) {
+                this->registry.setPermission(rows.at(x),-1);
+            }
+            removeBranchRows(rootForPermission(level),rows,row+1,last);
+            changes += last-row;
+        }
+    }
 
-    int idx = 0;
-    for (QMap<QString,QPair<QString,QDateTime>>::const_key_value_iterator i = this->xuidToGamertag.constKeyValueBegin(); i!=this->xuidToGamertag.constKeyValueEnd(); i++) {
-        QString xuid = (*i).first;
-        QString name = (*i).second.first;
-        QDateTime lastSeen = isOnline(xuid) ? QDateTime::currentDateTimeUtc() : (*i).second.second;
-        opts.setArrayIndex(idx++);
-        opts.setValue("xuid",xuid);
-        opts.setValue("name",name);
-        opts.setValue("lastSeen",lastSeen);
+    // Changed level, moved to the end of their new branch.
+    for(int level : levels) {
+        QList<QString> &rows = rowsForPermission(level);
+        for(int row=rows.size()-1;row>=0;row--) {
+            int newLevel = wanted.value(rows.at(row));
+            if (newLevel==level) {
+                continue;
+            }
+            this->registry.setPermission(rows.at(row),newLevel);
+            moveBranchRow(rootForPermission(level),rows,row,rootForPermission(newLevel),rowsForPermission(newLevel));
+            changes++;
+        }
+    }
 
+    // New, appended to their branch in one go.
+    for(int x=0;x<3;x++) {
+        QStringList added;
+        for(int y=0;y<lists[x]->size();y++) {
+            const QString &xuid = lists[x]->at(y);
+            if (this->registry.permission(xuid)<0 && wanted.value(xuid)==levels[x]) {
+                added.append(xuid);
+                this->registry.setPermission(xuid,levels[x]); // Also stops a repeated entry being added twice
+            }
+        }
+        if (!added.isEmpty()) {
+            appendBranchRows(rootForPermission(levels[x]),rowsForPermission(levels[x]),added);
+            changes += added.size();
+        }
+    }
+
+    this->permissionRowsChanged += changes;
+    if (changes>0) {
+        qDebug()<<"Permission list update changed"<<changes<<"rows";
+        emit this->serverPermissionsChanged();
     }
-    opts.endArray();
-    opts.endGroup();
 }
 
-void BedrockServerModel::loadUserMappings()
+// Views only see the first exposed[] rows of each branch, the rest are added by fetchMore.
+// Changes to rows past that point are made without telling the views.
+void BedrockServerModel::removeBranchRows(const QModelIndex &root, QList<QString> &rows, int first, int last)
 {
-    QSettings opts;
-
-    opts.beginGroup("users");
-    int size = opts.beginReadArray("mappings");
-    for(int x=0;x<size;x++) {
-        opts.setArrayIndex(x);
-        QString name = opts.value("name").toString();
-        QString xuid = opts.value("xuid").toString();
-        QDateTime lastSeen = opts.value("lastSeen").toDateTime();
-
-        if (lastSeen.addMonths(6) >= QDateTime::currentDateTimeUtc()) {
-            this->xuidToGamertag.insert(xuid,QPair<QString,QDateTime>(name,lastSeen));
-        }
+    int &shown = this->exposed[BRANCH_OF(root.internalId())];
+    int lastShown = qMin(last,shown-1);
+    if (first<=lastShown) {
+        this->beginRemoveRows(root,first,lastShown);
+    }
+    rows.erase(rows.begin()+first,rows.begin()+last+1);
+    if (first<=lastShown) {
+        shown -= lastShown-first+1;
+        this->endRemoveRows();
+    }
+}
+
+void BedrockServerModel::appendBranchRows(const QModelIndex &root, QList<QString> &rows, const QList<QString> &added)
+{
+    // Arrivals are shown if the branch is already showing everything, a big first list only up to a page.
+    int &shown = this->exposed[BRANCH_OF(root.internalId())];
+    int showing = (shown==rows.size()) ? qMin((int)added.size(),BRANCH_FETCH_ROWS) : 0;
+    if (showing>0) {
+        this->beginInsertRows(root,rows.size(),rows.size()+showing-1);
+    }
+    rows.append(added);
+    if (showing>0) {
+        shown += showing;
+        this->endInsertRows();
+    }
+}
+
+void BedrockServerModel::moveBranchRow(const QModelIndex &from, QList<QString> &source, int row, const QModelIndex &to, QList<QString> &destination)
+{
+    int &sourceShown = this->exposed[BRANCH_OF(from.internalId())];
+    int &destinationShown = this->exposed[BRANCH_OF(to.internalId())];
+    bool leaving = row<sourceShown;
+    bool arriving = destinationShown==destination.size();
+    if (leaving && arriving) {
+        this->beginMoveRows(from,row,row,to,destination.size());
+    } else if (leaving) {
+        this->beginRemoveRows(from,row,row);
+    } else if (arriving) {
+        this->beginInsertRows(to,destination.size(),destination.size());
+    }
+    destination.append(source.takeAt(row));
+    sourceShown -= leaving ? 1 : 0;
+    destinationShown += arriving ? 1 : 0;
+    if (leaving && arriving) {
+        this->endMoveRows();
+    } else if (leaving) {
+        this->endRemoveRows();
+    } else if (arriving) {
+        this->endInsertRows();
     }
 }
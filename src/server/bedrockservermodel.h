@@ -3,7 +3,11 @@
 
 #include <QAbstractItemModel>
 #include <server/bedrockserver.h>
+#include <server/playerregistry.h>
+#include <server/playermappings.h>
 #include <QList>
+#include <QIcon>
+#include <QTimer>
 
 class BedrockServerModel : public QAbstractItemModel
 {
@@ -13,6 +17,8 @@ public:
     explicit BedrockServerModel(BedrockServer *parent = nullptr);
     ~BedrockServerModel();
 
+    enum PlayerRole { XuidRole = Qt::UserRole+1,LastSeenRole,PermissionRole };
+
     // Header:
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
@@ -23,6 +29,11 @@ public:
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+
+    // Branches with thousands of players are handed to views a page at a time.
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
@@ -32,23 +43,42 @@ public:
     int getPermissionLevel(QString xuid);
     int onlinePlayerCount();
     int onlineOpCount();
+    quint64 permissionRowChanges(); // Rows inserted, removed or moved by permission list updates
 signals:
     void serverPermissionsChanged(); // Connect to this if you care about permission changes.
 private:
     BedrockServer *server;
+    PlayerMappings mappings;
+    PlayerRegistry registry;
+    // Row order of each branch of the tree, everything else about a player is in the registry.
     QList<QString> onlineUsers;
     QList<QString> opsByXuid;
     QList<QString> membersByXuid;
     QList<QString> visitorsByXuid;
-    QMap<QString,QPair<QString,QDateTime>> xuidToGamertag; // gamertag, <xuid,last seen time>
+    quint64 permissionRowsChanged;
+    int exposed[4]; // Rows of each branch the views have been told about
+    QTimer playerEventsTimer;
+    QList<QString> pendingJoins; // Online in the registry, not yet in onlineUsers
+    bool namesChanged;
+    QVariant branchLabels[4];
+    mutable QIcon folderIcon; // Made on first use, icons need the GUI up
+    mutable QIcon playerIcon;
+    mutable QList<QVariant> displayCache[4]; // Per branch and row, filled as rows are shown and dropped when rows change
     QModelIndex onlineRoot;
     QModelIndex opsRoot;
     QModelIndex membersRoot;
     QModelIndex visitorsRoot;
 
-    QString xuidToName(QString xuid) const;
-    void saveUserMappings();
-    void loadUserMappings();
+    const QList<QString> &rowsForBranch(int branch) const;
+    void invalidateDisplay(const QModelIndex &parent);
+    void updatePlayerName(const QString &xuid, const QString &name);
+    void flushPlayerEvents();
+    void updatePermissions(const QStringList &ops, const QStringList &members, const QStringList &visitors);
+    QList<QString> &rowsForPermission(int permission);
+    QModelIndex rootForPermission(int permission);
+    void removeBranchRows(const QModelIndex &root, QList<QString> &rows, int first, int last);
+    void appendBranchRows(const QModelIndex &root, QList<QString> &rows, const QList<QString> &added);
+    void moveBranchRow(const QModelIndex &from, QList<QString> &source, int row, const QModelIndex &to, QList<QString> &destination);
 };
 
 #endif // BEDROCKSERVERMODEL_H
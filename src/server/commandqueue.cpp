@@ -0,0 +1,214 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "commandqueue.h"
+#include <QStringList>
+
+#include <QDebug>
+
+CommandQueue::CommandQueue(QObject *parent) : QObject(parent),maxCommandsPerSecond(10),coalesceWindowMs(500),maxQueueLength(200),sent(0),merged(0),dropped(0)
+{
+    this->clock.start();
+    this->drainTimer.setSingleShot(true);
+    connect(&(this->drainTimer),&QTimer::timeout,this,&CommandQueue::drain);
+}
+
+void CommandQueue::enqueue(QString command)
+{
+    enqueue(command,priorityOf(command));
+}
+
+void CommandQueue::enqueue(QString command, Priority priority)
+{
+    if (priority==Urgent) {
+        // Backups and shutdown can't wait behind housekeeping.
+        send(command);
+        return;
+    }
+
+    bool idempotent = isIdempotent(command);
+    if (idempotent && mergeWithPending(command,priority)) {
+        this->merged++;
+        return;
+    }
+
+    qint64 now = this->clock.elapsed();
+    PendingCommand entry;
+    entry.command = command;
+    entry.notBefore = now;
+    if (idempotent && this->lastSent.contains(command)) {
+        qint64 windowEnds = this->lastSent.value(command) + this->coalesceWindowMs;
+        if (windowEnds > now) {
+            entry.notBefore = windowEnds;
+        }
+    }
+
+    if (pendingCount() >= this->maxQueueLength) {
+        dropForSpace();
+    }
+    this->pending[priority].append(entry);
+    drain();
+}
+
+void CommandQueue::clear()
+{
+    int count = pendingCount();
+    if (count>0) {
+        qDebug() << "Dropping"<<count<<"queued server command(s).";
+        this->dropped += count;
+    }
+    for(int x=0;x<=Housekeeping;x++) {
+        this->pending[x].clear();
+    }
+    this->lastSent.clear();
+    this->drainTimer.stop();
+}
+
+void CommandQueue::setMaxCommandsPerSecond(int count)
+{
+    this->maxCommandsPerSecond = count;
+    drain();
+}
+
+void CommandQueue::setCoalesceWindowMs(int ms)
+{
+    this->coalesceWindowMs = ms;
+}
+
+void CommandQueue::setMaxQueueLength(int length)
+{
+    this->maxQueueLength = (length < 1) ? 1 : length;
+}
+
+int CommandQueue::pendingCount()
+{
+    int count = 0;
+    for(int x=0;x<=Housekeeping;x++) {
+        count += this->pending[x].size();
+    }
+    return count;
+}
+
+quint64 CommandQueue::sentCount()
+{
+    return this->sent;
+}
+
+quint64 CommandQueue::mergedCount()
+{
+    return this->merged;
+}
+
+quint64 CommandQueue::droppedCount()
+{
+    return this->dropped;
+}
+
+CommandQueue::Priority CommandQueue::priorityOf(QString command)
+{
+    QString cmd = command.trimmed().toLower();
+
+    if (QStringList({"save hold","save resume","save query","stop"}).contains(cmd)) {
+        return Urgent;
+    } else if (QStringList({"permission list","permission reload","allowlist list","allowlist reload","whitelist list","whitelist reload","list"}).contains(cmd)) {
+        return Housekeeping;
+    }
+    return Normal;
+}
+
+bool CommandQueue::isIdempotent(QString command)
+{
+    // Queries and reloads, sending these twice in a row gives the same result as sending them once.
+    return QStringList({"permission list","permission reload","allowlist list","allowlist reload","whitelist list","whitelist reload","list"}).contains(command.trimmed().toLower());
+}
+
+void CommandQueue::send(QString command)
+{
+    qint64 now = this->clock.elapsed();
+    this->sent++;
+    this->recentSends.append(now);
+    if (isIdempotent(command)) {
+        this->lastSent.insert(command,now);
+    }
+    emit commandReady(command);
+}
+
+bool CommandQueue::mergeWithPending(QString command, Priority priority)
+{
+    QList<PendingCommand> &queue = this->pending[priority];
+    for(int x=0;x<queue.size();x++) {
+        if (queue[x].command==command) {
+            // Move it to the back so it still runs after anything queued since, eg. a 'permission reload'.
+            PendingCommand entry = queue.takeAt(x);
+            queue.append(entry);
+            return true;
+        }
+    }
+    return false;
+}
+
+void CommandQueue::dropForSpace()
+{
+    for(int x=Housekeeping;x>=Normal;x--) {
+        if (!this->pending[x].isEmpty()) {
+            qDebug() << "Command queue full, dropping: "<<this->pending[x].first().command;
+            this->pending[x].removeFirst();
+            this->dropped++;
+            return;
+        }
+    }
+}
+
+void CommandQueue::scheduleDrain()
+{
+    qint64 now = this->clock.elapsed();
+    qint64 wakeAt = -1;
+
+    // Earliest point any queue head is allowed out...
+    for(int x=Normal;x<=Housekeeping;x++) {
+        if (!this->pending[x].isEmpty()) {
+            qint64 head = this->pending[x].first().notBefore;
+            if (wakeAt<0 || head<wakeAt) {
+                wakeAt = head;
+            }
+        }
+    }
+    if (wakeAt<0) {
+        this->drainTimer.stop();
+        return;
+    }
+    // ...but not before the rate limit allows another send.
+    if (this->maxCommandsPerSecond>0 && this->recentSends.size()>=this->maxCommandsPerSecond) {
+        wakeAt = qMax(wakeAt,this->recentSends.first() + 1000);
+    }
+    this->drainTimer.start(qMax<qint64>(0,wakeAt-now));
+}
+
+void CommandQueue::drain()
+{
+    qint64 now = this->clock.elapsed();
+    while (!this->recentSends.isEmpty() && this->recentSends.first() <= now-1000) {
+        this->recentSends.removeFirst();
+    }
+
+    for(int x=Normal;x<=Housekeeping;x++) {
+        QList<PendingCommand> &queue = this->pending[x];
+        while (!queue.isEmpty() && queue.first().notBefore <= now) {
+            if (this->maxCommandsPerSecond>0 && this->recentSends.size()>=this->maxCommandsPerSecond) {
+                scheduleDrain();
+                return;
+            }
+            send(queue.takeFirst().command);
+        }
+    }
+    scheduleDrain();
+}
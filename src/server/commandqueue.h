@@ -0,0 +1,78 @@
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+
+// Sits in front of the server's stdin. Urgent commands (backup and stop) go straight out,
+// everything else is rate limited, and repeated queries like 'permission list' are merged.
+class CommandQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CommandQueue(QObject *parent = nullptr);
+
+    enum Priority { Urgent,Normal,Housekeeping };
+
+    void enqueue(QString command);
+    void enqueue(QString command, Priority priority);
+    void clear(); // Drops anything still waiting, eg. when the server process goes away.
+    void setMaxCommandsPerSecond(int count);
+    void setCoalesceWindowMs(int ms);
+    void setMaxQueueLength(int length);
+
+    int pendingCount();
+    quint64 sentCount();
+    quint64 mergedCount();
+    quint64 droppedCount();
+
+    static Priority priorityOf(QString command);
+    static bool isIdempotent(QString command);
+
+signals:
+    void commandReady(QString command); // Write this to the server.
+
+private:
+    class PendingCommand {
+    public:
+        QString command;
+        qint64 notBefore; // Idempotent queries are held back until the coalesce window has passed.
+    };
+
+    QList<PendingCommand> pending[Housekeeping+1];
+    QHash<QString,qint64> lastSent; // command -> clock ms, idempotent commands only.
+    QList<qint64> recentSends; // clock ms of sends in the last second.
+    QElapsedTimer clock;
+    QTimer drainTimer;
+    int maxCommandsPerSecond;
+    int coalesceWindowMs;
+    int maxQueueLength;
+    quint64 sent;
+    quint64 merged;
+    quint64 dropped;
+
+    void send(QString command);
+    bool mergeWithPending(QString command, Priority priority);
+    void dropForSpace();
+    void scheduleDrain();
+
+private slots:
+    void drain();
+};
+
+#endif // COMMANDQUEUE_H
@@ -0,0 +1,163 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "lifecycletimeline.h"
+#include <QSettings>
+#include <algorithm>
+
+#define LIFECYCLE_HISTORY_LENGTH 50
+#define LIFECYCLE_REGRESSION_MIN_RUNS 3 // Earlier runs needed before comparing
+#define LIFECYCLE_REGRESSION_FACTOR 1.5 // Slower than the median of earlier runs by this much...
+#define LIFECYCLE_REGRESSION_MIN_MS 5000 // ...and by at least this long, so small jitter isn't reported
+
+LifecycleTimeline::LifecycleTimeline(QObject *parent) : QObject(parent),completedShutdownMs(-1)
+{
+    clearTiming(this->current);
+    clearTiming(this->completedStart);
+}
+
+void LifecycleTimeline::clearTiming(Timing &timing)
+{
+    timing.spawned = QDateTime();
+    for(int x=0;x<PhaseCount;x++) {
+        timing.ms[x] = -1;
+        timing.serverMs[x] = -1;
+    }
+}
+
+qint64 LifecycleTimeline::parseServerTime(const QString &line)
+{
+    // [2024-11-16 15:28:59:265 INFO]
+    if (!line.startsWith("[") || line.size()<24) {
+        return -1;
+    }
+    QDateTime time = QDateTime::fromString(line.mid(1,23),"yyyy-MM-dd HH:mm:ss:zzz");
+    return time.isValid() ? time.toMSecsSinceEpoch() : -1;
+}
+
+void LifecycleTimeline::serverLine(const QString &line)
+{
+    if (!this->clock.isValid() || this->current.ms[Started]>=0) {
+        return;
+    }
+    if (this->current.ms[FirstLine]<0) {
+        mark(FirstLine,line);
+    }
+    if (this->current.ms[OpeningLevel]<0 && line.contains("Opening level")) {
+        mark(OpeningLevel,line);
+    } else if (line.contains("Server started.")) {
+        mark(Started,line);
+    }
+}
+
+void LifecycleTimeline::mark(Phase phase, const QString &line)
+{
+    if (phase==Spawned) {
+        clearTiming(this->current);
+        this->current.spawned = QDateTime::currentDateTime();
+        this->clock.start();
+    } else if (!this->clock.isValid() || this->current.ms[phase]>=0) {
+        return; // Not a process we started, or this phase has already happened.
+    }
+    this->current.ms[phase] = this->clock.elapsed();
+    this->current.serverMs[phase] = parseServerTime(line);
+
+    if (phase==Started) {
+        const Timing &t = this->current;
+        qint64 worldLoadMs = t.ms[OpeningLevel]>=0 ? t.ms[Started]-t.ms[OpeningLevel] : -1;
+        if (t.serverMs[OpeningLevel]>=0 && t.serverMs[Started]>=0) {
+            worldLoadMs = t.serverMs[Started]-t.serverMs[OpeningLevel]; // The server's clock doesn't include our read delays
+        }
+        QString summary = tr("Server started in %1 s").arg(t.ms[Started]/1000.0,0,'f',1);
+        if (t.ms[FirstLine]>=0) {
+            summary += tr(", first output after %1 s").arg(t.ms[FirstLine]/1000.0,0,'f',1);
+        }
+        if (worldLoadMs>=0) {
+            summary += tr(", world loaded in %1 s").arg(worldLoadMs/1000.0,0,'f',1);
+        }
+        checkRegression("lifecycle/starts",tr("Starting the server"),t.ms[Started]);
+        saveHistory("lifecycle/starts",t.ms[Started],worldLoadMs);
+        this->completedStart = this->current;
+        emit startTimed(t.ms[Started],summary+".");
+    } else if (phase==Exited) {
+        if (this->current.ms[StopSent]>=0) {
+            qint64 shutdownMs = this->current.ms[Exited]-this->current.ms[StopSent];
+            checkRegression("lifecycle/stops",tr("Stopping the server"),shutdownMs);
+            saveHistory("lifecycle/stops",shutdownMs);
+            this->completedShutdownMs = shutdownMs;
+            emit stopTimed(shutdownMs,tr("Server stopped %1 s after being asked to.").arg(shutdownMs/1000.0,0,'f',1));
+        }
+        this->clock.invalidate();
+    }
+}
+
+LifecycleTimeline::Timing LifecycleTimeline::lastStart()
+{
+    return this->completedStart;
+}
+
+qint64 LifecycleTimeline::lastShutdownMs()
+{
+    return this->completedShutdownMs;
+}
+
+QList<qint64> LifecycleTimeline::loadHistory(QString key)
+{
+    QList<qint64> history;
+    QSettings settings;
+    int size = settings.beginReadArray(key);
+    for(int x=0;x<size;x++) {
+        settings.setArrayIndex(x);
+        history.append(settings.value("totalMs").toLongLong());
+    }
+    settings.endArray();
+    return history;
+}
+
+void LifecycleTimeline::saveHistory(QString key, qint64 ms, qint64 secondaryMs)
+{
+    QSettings settings;
+    QList<QList<QVariant>> entries;
+    int size = settings.beginReadArray(key);
+    for(int x=qMax(0,size-LIFECYCLE_HISTORY_LENGTH+1);x<size;x++) {
+        settings.setArrayIndex(x);
+        entries.append({settings.value("when"),settings.value("totalMs"),settings.value("worldLoadMs")});
+    }
+    settings.endArray();
+    entries.append({QDateTime::currentDateTime(),ms,secondaryMs});
+
+    settings.beginWriteArray(key,entries.size());
+    for(int x=0;x<entries.size();x++) {
+        settings.setArrayIndex(x);
+        settings.setValue("when",entries.at(x).at(0));
+        settings.setValue("totalMs",entries.at(x).at(1));
+        if (entries.at(x).at(2).toLongLong()>=0 && !entries.at(x).at(2).isNull()) {
+            settings.setValue("worldLoadMs",entries.at(x).at(2));
+        } else {
+            settings.remove("worldLoadMs");
+        }
+    }
+    settings.endArray();
+}
+
+void LifecycleTimeline::checkRegression(QString key, QString what, qint64 ms)
+{
+    QList<qint64> history = loadHistory(key);
+    if (history.size()<LIFECYCLE_REGRESSION_MIN_RUNS) {
+        return;
+    }
+    std::sort(history.begin(),history.end());
+    qint64 median = history.at(history.size()/2);
+    if (ms>median*LIFECYCLE_REGRESSION_FACTOR && ms-median>=LIFECYCLE_REGRESSION_MIN_MS) {
+        emit regression(tr("%1 took %2 s, usually it takes about %3 s.").arg(what).arg(ms/1000.0,0,'f',1).arg(median/1000.0,0,'f',1));
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef LIFECYCLETIMELINE_H
+#define LIFECYCLETIMELINE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+
+// Times each start and stop of the server process. Phases are measured on a monotonic
+// clock from the process being spawned, and where the server printed a timestamp that
+// is kept too. Completed starts and stops are kept in the settings and compared with
+// earlier ones so slower restarts, eg. from a growing world or an update, get noticed.
+class LifecycleTimeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LifecycleTimeline(QObject *parent = nullptr);
+
+    enum Phase { Spawned,FirstLine,OpeningLevel,Started,StopSent,Exited,PhaseCount };
+
+    class Timing {
+    public:
+        QDateTime spawned;
+        qint64 ms[PhaseCount]; // Monotonic ms since spawning, -1 if it hasn't happened
+        qint64 serverMs[PhaseCount]; // The server's own timestamp in ms since the epoch, -1 if none was printed
+    };
+
+    void mark(Phase phase, const QString &line = QString());
+    void serverLine(const QString &line); // Every line the server prints, picks out the phases.
+    Timing lastStart(); // The most recent start that completed
+    qint64 lastShutdownMs(); // -1 until a stop has been timed
+
+signals:
+    void startTimed(qint64 totalMs, QString summary);
+    void stopTimed(qint64 totalMs, QString summary);
+    void regression(QString message);
+
+private:
+    QElapsedTimer clock;
+    Timing current;
+    Timing completedStart;
+    qint64 completedShutdownMs;
+
+    static qint64 parseServerTime(const QString &line);
+    static void clearTiming(Timing &timing);
+    QList<qint64> loadHistory(QString key);
+    void saveHistory(QString key, qint64 ms, qint64 secondaryMs = -1);
+    void checkRegression(QString key, QString what, qint64 ms);
+};
+
+#endif // LIFECYCLETIMELINE_H
@@ -0,0 +1,163 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "outputthrottle.h"
+
+OutputThrottle::OutputThrottle(QObject *parent) : QObject(parent),maxRate(200),bucketStart(0),bucketCount(0),previousBucketCount(0),pendingRepeats(0),pendingDropped(0),dropped(0),summarized(0)
+{
+    this->clock.start();
+    // If a flood just stops there's no next line to trigger the summary.
+    this->flushTimer.setSingleShot(true);
+    this->flushTimer.setInterval(1000);
+    connect(&(this->flushTimer),&QTimer::timeout,this,&OutputThrottle::flushSummaries);
+}
+
+bool OutputThrottle::admit(const QString &line)
+{
+    countLine();
+
+    if (!isFlooding()) {
+        flushSummaries();
+        this->lastKey.clear();
+        return true;
+    }
+
+    QString key = similarityKey(line);
+    if (key==this->lastKey) {
+        this->pendingRepeats++;
+        this->summarized++;
+        startFlushTimer();
+        return false;
+    }
+
+    // Something different, so the run of repeats has ended.
+    if (this->pendingRepeats>0) {
+        emit summary(tr("%Ln similar line(s) suppressed: %1","",this->pendingRepeats).arg(this->lastLine));
+        this->pendingRepeats = 0;
+    }
+    this->lastKey = key;
+    this->lastLine = line;
+
+    if (isLowPriority(line)) {
+        this->pendingDropped++;
+        this->dropped++;
+        startFlushTimer();
+        return false;
+    }
+    return true;
+}
+
+void OutputThrottle::startFlushTimer()
+{
+    // Never restarted while running, so a long flood still gets a summary every second.
+    if (!this->flushTimer.isActive()) {
+        this->flushTimer.start();
+    }
+}
+
+void OutputThrottle::setMaxLinesPerSecond(int count)
+{
+    this->maxRate = count;
+}
+
+int OutputThrottle::maxLinesPerSecond()
+{
+    return this->maxRate;
+}
+
+int OutputThrottle::currentLineRate()
+{
+    // Sliding estimate over two one second buckets.
+    qint64 now = this->clock.elapsed();
+    if (now - this->bucketStart >= 2000) {
+        return 0;
+    } else if (now - this->bucketStart >= 1000) {
+        return this->bucketCount;
+    }
+    qint64 intoBucket = now - this->bucketStart;
+    return this->bucketCount + (this->previousBucketCount * (1000 - intoBucket)) / 1000;
+}
+
+bool OutputThrottle::isFlooding()
+{
+    return this->maxRate>0 && currentLineRate() > this->maxRate;
+}
+
+quint64 OutputThrottle::droppedCount()
+{
+    return this->dropped;
+}
+
+quint64 OutputThrottle::summarizedCount()
+{
+    return this->summarized;
+}
+
+bool OutputThrottle::isLowPriority(const QString &line)
+{
+    // Errors, warnings and player activity are always worth showing.
+    return !(line.contains("ERROR") || line.contains("WARN") || line.contains("Player "));
+}
+
+QString OutputThrottle::similarityKey(const QString &line)
+{
+    int start = 0;
+    if (line.startsWith('[')) {
+        // Skip the timestamp prefix, eg. [2024-11-16 15:28:59:265 INFO]
+        int idx = line.indexOf(']');
+        start = (idx>-1) ? idx+1 : 0;
+    }
+
+    QString key;
+    key.reserve(line.size()-start);
+    bool lastWasDigit = false;
+    for(int x=start;x<line.size();x++) {
+        QChar c = line.at(x);
+        if (c.isDigit()) {
+            // Counters and timings differ between otherwise identical lines.
+            if (!lastWasDigit) {
+                key.append('#');
+            }
+            lastWasDigit = true;
+        } else {
+            key.append(c);
+            lastWasDigit = false;
+        }
+    }
+    return key;
+}
+
+void OutputThrottle::countLine()
+{
+    qint64 now = this->clock.elapsed();
+    if (now - this->bucketStart >= 1000) {
+        this->previousBucketCount = (now - this->bucketStart >= 2000) ? 0 : this->bucketCount;
+        this->bucketStart = now - ((now - this->bucketStart) % 1000);
+        this->bucketCount = 0;
+    }
+    this->bucketCount++;
+}
+
+void OutputThrottle::flushSummaries()
+{
+    if (this->pendingRepeats>0) {
+        emit summary(tr("%Ln similar line(s) suppressed: %1","",this->pendingRepeats).arg(this->lastLine));
+        this->pendingRepeats = 0;
+    }
+    if (this->pendingDropped>0) {
+        emit summary(tr("%Ln line(s) dropped during an output flood, %1 dropped and %2 summarised in total.","",this->pendingDropped)
+                     .arg(this->dropped)
+                     .arg(this->summarized));
+        this->pendingDropped = 0;
+    }
+    this->flushTimer.stop();
+}
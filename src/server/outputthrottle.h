@@ -0,0 +1,62 @@
+#ifndef OUTPUTTHROTTLE_H
+#define OUTPUTTHROTTLE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// Decides which server lines reach the console. Below the configured rate everything
+// passes, above it repeats are collapsed into a summary and low priority lines dropped.
+// Event detection doesn't go through here, it sees every line.
+class OutputThrottle : public QObject
+{
+    Q_OBJECT
+public:
+    explicit OutputThrottle(QObject *parent = nullptr);
+
+    bool admit(const QString &line); // True if the line should be shown.
+    void setMaxLinesPerSecond(int count); // 0 turns throttling off.
+    int maxLinesPerSecond();
+    int currentLineRate();
+    bool isFlooding();
+    quint64 droppedCount();
+    quint64 summarizedCount();
+
+    static bool isLowPriority(const QString &line);
+    static QString similarityKey(const QString &line);
+
+signals:
+    void summary(QString message); // Shown in place of lines that weren't admitted.
+
+private:
+    QElapsedTimer clock;
+    QTimer flushTimer;
+    int maxRate;
+    qint64 bucketStart;
+    int bucketCount;
+    int previousBucketCount;
+    QString lastKey;
+    QString lastLine;
+    int pendingRepeats;
+    int pendingDropped;
+    quint64 dropped;
+    quint64 summarized;
+
+    void countLine();
+    void startFlushTimer();
+    void flushSummaries();
+};
+
+#endif // OUTPUTTHROTTLE_H
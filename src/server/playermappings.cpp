@@ -0,0 +1,296 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "playermappings.h"
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QDir>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+#define PLAYER_MAPPINGS_MAGIC "MCBCMAP1\n"
+#define PLAYER_MAPPINGS_MAGIC_LENGTH 9
+#define PLAYER_MAPPINGS_MIN_JOURNAL 65536 // Bytes, below this the journal is never worth compacting
+#define PLAYER_MAPPINGS_KEEP_MONTHS 6
+
+PlayerMappings::PlayerMappings(QString folder) : folder(folder),snapshotData(nullptr),snapshotSize(0)
+{
+    QDir().mkpath(folder);
+    this->snapshot.setFileName(QDir(folder).filePath(PLAYER_MAPPINGS_SNAPSHOT));
+    this->journal.setFileName(QDir(folder).filePath(PLAYER_MAPPINGS_JOURNAL));
+    openSnapshot();
+    openJournal();
+    // The settings are only removed once migrated mappings are in a snapshot, so a migration
+    // that couldn't be written is tried again next time.
+    if (migrateSettings()) {
+        if (compact()) {
+            QSettings().remove("users/mappings");
+        } else {
+            qDebug()<<"Player mappings not migrated from the settings yet, trying again next time";
+        }
+    } else if (this->journal.size()>qMax((qint64)PLAYER_MAPPINGS_MIN_JOURNAL,this->snapshotSize/4)) {
+        compact(); // Left over from a run that stopped before it got round to it
+    }
+}
+
+PlayerMappings::~PlayerMappings()
+{
+    closeSnapshot();
+}
+
+QString PlayerMappings::defaultFolder()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+}
+
+bool PlayerMappings::find(const QString &xuid, Mapping &mapping) const
+{
+    auto i = this->journalled.constFind(xuid);
+    if (i!=this->journalled.constEnd()) {
+        mapping = i.value();
+        return true;
+    }
+    if (!this->snapshotData) {
+        return false;
+    }
+
+    // Binary search the lines. lo and hi are always the start of a line, or the end.
+    QByteArray key = xuid.toUtf8();
+    const char *data = (const char*)this->snapshotData;
+    qint64 lo = PLAYER_MAPPINGS_MAGIC_LENGTH;
+    qint64 hi = this->snapshotSize;
+    while (lo<hi) {
+        qint64 start = lo+(hi-lo)/2;
+        while (start>lo && data[start-1]!='\n') {
+            start--;
+        }
+        const char *newline = (const char*)memchr(data+start,'\n',hi-start);
+        qint64 end = newline ? newline-data : hi;
+        const char *tab = (const char*)memchr(data+start,'\t',end-start);
+        qint64 keyLength = tab ? tab-(data+start) : end-start;
+        int order = memcmp(data+start,key.constData(),qMin(keyLength,(qint64)key.size()));
+        if (order==0) {
+            order = (keyLength<key.size()) ? -1 : (keyLength>key.size()) ? 1 : 0;
+        }
+        if (order==0) {
+            QString found;
+            return parseLine(data+start,end-start,found,mapping);
+        } else if (order<0) {
+            lo = end+1;
+        } else {
+            hi = start;
+        }
+    }
+    return false;
+}
+
+void PlayerMappings::record(const QString &xuid, const QString &name, const QDateTime &lastSeen)
+{
+    Mapping mapping;
+    mapping.name = name;
+    mapping.lastSeen = lastSeen;
+    this->journalled.insert(xuid,mapping);
+    if (this->journal.isOpen()) {
+        this->journal.write(formatLine(xuid,mapping));
+        this->journal.flush();
+    }
+    // Compacting once the journal is a quarter of the snapshot keeps the cost per change constant.
+    if (this->journal.size()>qMax((qint64)PLAYER_MAPPINGS_MIN_JOURNAL,this->snapshotSize/4)) {
+        compact();
+    }
+}
+
+bool PlayerMappings::compact()
+{
+    QSaveFile out(this->snapshot.fileName());
+    if (!out.open(QIODevice::WriteOnly)) {
+        qDebug()<<"Can't write player mappings"<<out.fileName()<<out.errorString();
+        return false;
+    }
+    QDateTime oldest = QDateTime::currentDateTimeUtc().addMonths(-PLAYER_MAPPINGS_KEEP_MONTHS);
+    QList<QString> xuids = this->journalled.keys();
+    QList<QByteArray> keys;
+    for(int x=0;x<xuids.size();x++) {
+        keys.append(xuids.at(x).toUtf8());
+    }
+    std::sort(keys.begin(),keys.end());
+
+    // Merge the sorted journal into the sorted snapshot, dropping anyone not seen for months.
+    out.write(PLAYER_MAPPINGS_MAGIC);
+    int next = 0;
+    auto writeJournalled = [&](const QByteArray &key) {
+        QString xuid = QString::fromUtf8(key);
+        const Mapping &mapping = this->journalled[xuid];
+        if (mapping.lastSeen>=oldest) {
+            out.write(formatLine(xuid,mapping));
+        }
+    };
+    const char *data = (const char*)this->snapshotData;
+    qint64 pos = PLAYER_MAPPINGS_MAGIC_LENGTH;
+    while (data && pos<this->snapshotSize) {
+        const char *newline = (const char*)memchr(data+pos,'\n',this->snapshotSize-pos);
+        qint64 end = newline ? newline-data : this->snapshotSize;
+        QString xuid;
+        Mapping mapping;
+        if (parseLine(data+pos,end-pos,xuid,mapping)) {
+            QByteArray key = xuid.toUtf8();
+            while (next<keys.size() && keys.at(next)<key) {
+                writeJournalled(keys.at(next++));
+            }
+            if (next<keys.size() && keys.at(next)==key) {
+                writeJournalled(keys.at(next++));
+            } else if (mapping.lastSeen>=oldest) {
+                out.write(data+pos,end-pos);
+                out.write("\n");
+            }
+        }
+        pos = end+1;
+    }
+    while (next<keys.size()) {
+        writeJournalled(keys.at(next++));
+    }
+
+    // Windows won't replace a file that's open, so let go of the old one first.
+    closeSnapshot();
+    bool written = out.commit();
+    openSnapshot();
+    if (!written) {
+        qDebug()<<"Can't replace player mappings"<<out.fileName()<<out.errorString();
+        return false;
+    }
+    this->journalled.clear();
+    this->journal.resize(0);
+    return true;
+}
+
+bool PlayerMappings::readSnapshot(QString folder, std::function<void(const QString &xuid, const Mapping &mapping)> handler)
+{
+    QFile file(QDir(folder).filePath(PLAYER_MAPPINGS_SNAPSHOT));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray contents = file.readAll();
+    if (!contents.startsWith(PLAYER_MAPPINGS_MAGIC)) {
+        return false;
+    }
+    qint64 pos = PLAYER_MAPPINGS_MAGIC_LENGTH;
+    while (pos<contents.size()) {
+        qint64 end = contents.indexOf('\n',pos);
+        end = (end<0) ? contents.size() : end;
+        QString xuid;
+        Mapping mapping;
+        if (parseLine(contents.constData()+pos,end-pos,xuid,mapping)) {
+            handler(xuid,mapping);
+        }
+        pos = end+1;
+    }
+    return true;
+}
+
+void PlayerMappings::openSnapshot()
+{
+    if (!this->snapshot.open(QIODevice::ReadOnly)) {
+        return; // Nothing compacted yet
+    }
+    this->snapshotSize = this->snapshot.size();
+    this->snapshotData = this->snapshot.map(0,this->snapshotSize);
+    if (!this->snapshotData || this->snapshotSize<PLAYER_MAPPINGS_MAGIC_LENGTH ||
+            memcmp(this->snapshotData,PLAYER_MAPPINGS_MAGIC,PLAYER_MAPPINGS_MAGIC_LENGTH)!=0) {
+        qDebug()<<"Ignoring unreadable player mappings"<<this->snapshot.fileName();
+        closeSnapshot();
+    }
+}
+
+void PlayerMappings::closeSnapshot()
+{
+    if (this->snapshotData) {
+        this->snapshot.unmap((uchar*)this->snapshotData);
+    }
+    this->snapshot.close();
+    this->snapshotData = nullptr;
+    this->snapshotSize = 0;
+}
+
+void PlayerMappings::openJournal()
+{
+    if (!this->journal.open(QIODevice::ReadWrite|QIODevice::Append)) {
+        qDebug()<<"Can't open player mappings journal"<<this->journal.fileName()<<this->journal.errorString();
+        return;
+    }
+    this->journal.seek(0);
+    QByteArray contents = this->journal.readAll();
+    qint64 complete = contents.lastIndexOf('\n')+1;
+    if (complete<contents.size()) {
+        this->journal.resize(complete); // The tail of a write cut short by a crash
+    }
+    qint64 pos = 0;
+    while (pos<complete) {
+        qint64 end = contents.indexOf('\n',pos);
+        QString xuid;
+        Mapping mapping;
+        if (parseLine(contents.constData()+pos,end-pos,xuid,mapping)) {
+            this->journalled.insert(xuid,mapping);
+        }
+        pos = end+1;
+    }
+}
+
+bool PlayerMappings::migrateSettings()
+{
+    // Mappings used to be an array in the settings, rewritten in full on every exit.
+    QDateTime oldest = QDateTime::currentDateTimeUtc().addMonths(-PLAYER_MAPPINGS_KEEP_MONTHS);
+    QSettings opts;
+    opts.beginGroup("users");
+    int size = opts.beginReadArray("mappings");
+    for(int x=0;x<size;x++) {
+        opts.setArrayIndex(x);
+        Mapping mapping;
+        mapping.name = opts.value("name").toString();
+        mapping.lastSeen = opts.value("lastSeen").toDateTime();
+        QString xuid = opts.value("xuid").toString();
+        Mapping known;
+        if (mapping.lastSeen>=oldest && !(find(xuid,known) && known.lastSeen>=mapping.lastSeen)) {
+            this->journalled.insert(xuid,mapping); // A retry mustn't undo anything seen since
+        }
+    }
+    opts.endArray();
+    opts.endGroup();
+    return size>0;
+}
+
+bool PlayerMappings::parseLine(const char *line, qint64 length, QString &xuid, Mapping &mapping)
+{
+    const char *first = (const char*)memchr(line,'\t',length);
+    const char *second = first ? (const char*)memchr(first+1,'\t',line+length-first-1) : nullptr;
+    if (!second) {
+        return false;
+    }
+    bool ok = false;
+    qint64 lastSeen = QByteArray::fromRawData(first+1,second-first-1).toLongLong(&ok);
+    if (!ok || first==line) {
+        return false;
+    }
+    xuid = QString::fromUtf8(line,first-line);
+    mapping.name = QString::fromUtf8(second+1,line+length-second-1);
+    mapping.lastSeen = QDateTime::fromSecsSinceEpoch(lastSeen);
+    return true;
+}
+
+QByteArray PlayerMappings::formatLine(const QString &xuid, const Mapping &mapping)
+{
+    // Gamertags can't hold tabs or new lines, but nothing read back should be able to break a line.
+    QString name = mapping.name;
+    name.replace('\t',' ').replace('\n',' ').replace('\r',' ');
+    return xuid.toUtf8()+'\t'+QByteArray::number(mapping.lastSeen.toSecsSinceEpoch())+'\t'+name.toUtf8()+'\n';
+}
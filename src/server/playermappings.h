@@ -0,0 +1,64 @@
+#ifndef PLAYERMAPPINGS_H
+#define PLAYERMAPPINGS_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QFile>
+#include <QHash>
+#include <QDateTime>
+#include <functional>
+
+#define PLAYER_MAPPINGS_SNAPSHOT "players.map"
+#define PLAYER_MAPPINGS_JOURNAL "players.journal"
+
+// Gamertag and last seen time for every xuid the console has seen. The snapshot is a
+// sorted text file of 'xuid<tab>last seen<tab>name' lines, memory mapped and binary
+// searched on lookup so nothing is parsed at startup. Changes are appended to a journal
+// as they happen, and folded into a new snapshot once the journal is a quarter of its
+// size, so saving costs the same however many players are known.
+class PlayerMappings
+{
+public:
+    explicit PlayerMappings(QString folder);
+    ~PlayerMappings();
+
+    class Mapping {
+    public:
+        QString name;
+        QDateTime lastSeen;
+    };
+
+    bool find(const QString &xuid, Mapping &mapping) const;
+    void record(const QString &xuid, const QString &name, const QDateTime &lastSeen);
+    bool compact(); // False if the snapshot couldn't be replaced, the journal is kept
+
+    static QString defaultFolder();
+    static bool readSnapshot(QString folder, std::function<void(const QString &xuid, const Mapping &mapping)> handler);
+
+private:
+    QString folder;
+    QFile snapshot;
+    const uchar *snapshotData;
+    qint64 snapshotSize;
+    QFile journal;
+    QHash<QString,Mapping> journalled; // Everything in the journal, newest wins
+
+    void openSnapshot();
+    void closeSnapshot();
+    void openJournal();
+    bool migrateSettings();
+    static bool parseLine(const char *line, qint64 length, QString &xuid, Mapping &mapping);
+    static QByteArray formatLine(const QString &xuid, const Mapping &mapping);
+};
+
+#endif // PLAYERMAPPINGS_H
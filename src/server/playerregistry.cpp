@@ -0,0 +1,92 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "playerregistry.h"
+#include <server/bedrockserver.h>
+
+PlayerRegistry::PlayerRegistry() : mappings(nullptr),online(0),onlineOperators(0)
+{
+}
+
+const PlayerRegistry::Player *PlayerRegistry::find(const QString &xuid) const
+{
+    auto i = this->byXuid.constFind(xuid);
+    return i==this->byXuid.constEnd() ? nullptr : &i.value();
+}
+
+QString PlayerRegistry::name(const QString &xuid) const
+{
+    const Player *player = find(xuid);
+    if (player && !player->name.isEmpty()) {
+        return player->name;
+    }
+    PlayerMappings::Mapping mapping;
+    return (this->mappings && this->mappings->find(xuid,mapping)) ? mapping.name : xuid;
+}
+
+void PlayerRegistry::setMappings(const PlayerMappings *mappings)
+{
+    this->mappings = mappings;
+}
+
+int PlayerRegistry::permission(const QString &xuid) const
+{
+    const Player *player = find(xuid);
+    return player ? player->permission : -1;
+}
+
+bool PlayerRegistry::isOnline(const QString &xuid) const
+{
+    const Player *player = find(xuid);
+    return player && player->online;
+}
+
+int PlayerRegistry::onlineCount() const
+{
+    return this->online;
+}
+
+int PlayerRegistry::onlineOperatorCount() const
+{
+    return this->onlineOperators;
+}
+
+void PlayerRegistry::setName(const QString &xuid, const QString &name)
+{
+    this->byXuid[xuid].name = name;
+}
+
+void PlayerRegistry::setOnline(const QString &xuid, bool online)
+{
+    Player &player = this->byXuid[xuid];
+    if (player.online==online) {
+        return;
+    }
+    player.online = online;
+    int change = online ? 1 : -1;
+    this->online += change;
+    if (player.permission==BedrockServer::Operator) {
+        this->onlineOperators += change;
+    }
+}
+
+void PlayerRegistry::setPermission(const QString &xuid, int permission)
+{
+    Player &player = this->byXuid[xuid];
+    if (player.online && player.permission==BedrockServer::Operator) {
+        this->onlineOperators--;
+    }
+    player.permission = permission;
+    if (player.online && player.permission==BedrockServer::Operator) {
+        this->onlineOperators++;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef PLAYERREGISTRY_H
+#define PLAYERREGISTRY_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QHash>
+#include <QString>
+#include "playermappings.h"
+
+// Everything known about each player, keyed by xuid so every lookup is constant time
+// however many players the server has seen. Online and online operator counts are kept
+// up to date as players change rather than counted on demand. Names of players not seen
+// since the console started come from the mappings.
+class PlayerRegistry
+{
+public:
+    PlayerRegistry();
+
+    class Player {
+    public:
+        QString name; // Empty until the player has been seen
+        int permission = -1; // BedrockServer::PermissionLevel, -1 if not in permissions.json
+        bool online = false;
+    };
+
+    const Player *find(const QString &xuid) const; // nullptr if unknown
+    QString name(const QString &xuid) const; // The xuid if the name isn't known
+    void setMappings(const PlayerMappings *mappings);
+    int permission(const QString &xuid) const;
+    bool isOnline(const QString &xuid) const;
+    int onlineCount() const;
+    int onlineOperatorCount() const;
+
+    void setName(const QString &xuid, const QString &name);
+    void setOnline(const QString &xuid, bool online);
+    void setPermission(const QString &xuid, int permission);
+
+private:
+    QHash<QString,Player> byXuid;
+    const PlayerMappings *mappings;
+    int online;
+    int onlineOperators;
+};
+
+#endif // PLAYERREGISTRY_H
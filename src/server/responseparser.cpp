@@ -0,0 +1,237 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "responseparser.h"
+
+#include <QDebug>
+
+ResponseParser::ResponseParser(QObject *parent) : QObject(parent),active(false),failed(false),complete(false),expectingKey(false),tokenState(NoToken),unicodeValue(0),unicodeDigits(0),entryIgnoresPlayerLimit(false)
+{
+}
+
+void ResponseParser::begin()
+{
+    if (this->active && !this->complete) {
+        fail("new response started before the previous one finished");
+    }
+    this->active = true;
+    this->failed = false;
+    this->complete = false;
+    this->stack.clear();
+    this->keys.clear();
+    this->expectingKey = false;
+    this->tokenState = NoToken;
+    this->token.clear();
+    this->command.clear();
+}
+
+void ResponseParser::feed(QStringView line)
+{
+    if (!isActive()) {
+        return;
+    }
+    for(auto i=line.begin();i!=line.end() && isActive();i++) {
+        processChar(*i);
+    }
+    // Lines only ever break between tokens.
+    if (isActive()) {
+        processChar('\n');
+    }
+}
+
+void ResponseParser::end()
+{
+    if (isActive()) {
+        fail("response ended with unterminated JSON");
+    }
+    this->active = false;
+}
+
+bool ResponseParser::isActive()
+{
+    return this->active && !this->failed && !this->complete;
+}
+
+void ResponseParser::processChar(QChar c)
+{
+    switch (this->tokenState) {
+    case StringToken:
+        if (c=='\\') {
+            this->tokenState = StringEscape;
+        } else if (c=='"') {
+            this->tokenState = NoToken;
+            handleValue(this->token,true);
+        } else {
+            this->token.append(c);
+        }
+        return;
+    case StringEscape:
+        this->tokenState = StringToken;
+        switch (c.unicode()) {
+        case 'b' : this->token.append('\b'); break;
+        case 'f' : this->token.append('\f'); break;
+        case 'n' : this->token.append('\n'); break;
+        case 'r' : this->token.append('\r'); break;
+        case 't' : this->token.append('\t'); break;
+        case 'u' :
+            this->tokenState = StringUnicode;
+            this->unicodeValue = 0;
+            this->unicodeDigits = 0;
+            break;
+        default : this->token.append(c); // \" \\ and \/
+        }
+        return;
+    case StringUnicode: {
+        ushort u = c.unicode();
+        int digit = (u>='0' && u<='9') ? u-'0' :
+                    (u>='a' && u<='f') ? u-'a'+10 :
+                    (u>='A' && u<='F') ? u-'A'+10 :
+                    -1;
+        if (digit<0) {
+            fail("bad unicode escape");
+            return;
+        }
+        this->unicodeValue = (this->unicodeValue << 4) | digit;
+        if (++this->unicodeDigits==4) {
+            this->token.append(QChar(this->unicodeValue));
+            this->tokenState = StringToken;
+        }
+        return;
+    }
+    case LiteralToken:
+        if (c.isLetterOrNumber() || c=='-' || c=='+' || c=='.') {
+            this->token.append(c);
+            return;
+        }
+        this->tokenState = NoToken;
+        handleValue(this->token,false);
+        if (!isActive()) {
+            return;
+        }
+        break; // c still needs handling.
+    case NoToken:
+        break;
+    }
+
+    if (c.isSpace()) {
+        return;
+    }
+    switch (c.unicode()) {
+    case '{' : openContainer(ObjectContainer); break;
+    case '[' : openContainer(ArrayContainer); break;
+    case '}' : closeContainer(ObjectContainer); break;
+    case ']' : closeContainer(ArrayContainer); break;
+    case ':' : this->expectingKey = false; break;
+    case ',' : this->expectingKey = (!this->stack.isEmpty() && this->stack.last()==ObjectContainer); break;
+    case '"' :
+        this->token.clear();
+        this->tokenState = StringToken;
+        break;
+    default :
+        if (c.isLetterOrNumber() || c=='-') {
+            this->token = c;
+            this->tokenState = LiteralToken;
+        } else {
+            fail(QString("unexpected character '%1'").arg(c));
+        }
+    }
+}
+
+void ResponseParser::handleValue(const QString &text, bool isString)
+{
+    if (this->stack.isEmpty()) {
+        fail("value outside of an object");
+        return;
+    }
+    if (this->stack.last()==ObjectContainer && this->expectingKey) {
+        this->keys.last() = text;
+        return;
+    }
+
+    int depth = this->stack.size();
+    if (depth==1 && this->keys[0]=="command") {
+        this->command = text;
+    } else if (depth==2 && inResultArray() && isString) {
+        emit this->operatorEntry(text);
+    } else if (depth==3 && inResultArray() && this->stack[2]==ObjectContainer) {
+        const QString &key = this->keys[2];
+        if (key=="xuid") {
+            this->entryXuid = text;
+        } else if (key=="permission") {
+            this->entryPermission = text;
+        } else if (key=="name") {
+            this->entryName = text;
+        } else if (key=="ignoresPlayerLimit") {
+            this->entryIgnoresPlayerLimit = (text=="true");
+        }
+    }
+}
+
+void ResponseParser::openContainer(Container container)
+{
+    if (this->stack.isEmpty() && container!=ObjectContainer) {
+        fail("response is not an object");
+        return;
+    }
+    this->stack.append(container);
+    this->keys.append(QString());
+    this->expectingKey = (container==ObjectContainer);
+
+    if (this->stack.size()==3 && inResultArray()) {
+        // New result entry
+        this->entryXuid.clear();
+        this->entryPermission.clear();
+        this->entryName.clear();
+        this->entryIgnoresPlayerLimit = false;
+    }
+}
+
+void ResponseParser::closeContainer(Container container)
+{
+    if (this->stack.isEmpty() || this->stack.last()!=container) {
+        fail("mismatched brackets");
+        return;
+    }
+    if (this->stack.size()==3 && container==ObjectContainer && inResultArray()) {
+        // Entries are told apart by their fields, the 'command' key isn't always first.
+        if (!this->entryXuid.isEmpty() && !this->entryPermission.isEmpty()) {
+            emit this->permissionEntry(this->entryXuid,this->entryPermission);
+        } else if (!this->entryName.isEmpty()) {
+            emit this->allowlistEntry(this->entryName,this->entryIgnoresPlayerLimit);
+        }
+    }
+    this->stack.removeLast();
+    this->keys.removeLast();
+    this->expectingKey = false;
+
+    if (this->stack.isEmpty()) {
+        finish();
+    }
+}
+
+bool ResponseParser::inResultArray()
+{
+    return this->stack.size()>=2 && this->stack[1]==ArrayContainer && this->keys[0]=="result";
+}
+
+void ResponseParser::fail(QString reason)
+{
+    qDebug() << "Unable to parse server response:"<<reason;
+    this->failed = true;
+    emit this->responseComplete(this->command,false);
+}
+
+void ResponseParser::finish()
+{
+    this->complete = true;
+    emit this->responseComplete(this->command,true);
+}
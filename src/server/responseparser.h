@@ -0,0 +1,71 @@
+#ifndef RESPONSEPARSER_H
+#define RESPONSEPARSER_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QStringView>
+#include <QStringList>
+#include <QVarLengthArray>
+
+// Incremental parser for the JSON the server prints between '###* ' and ' *###'.
+// Lines are fed in as they arrive and entries from the 'result' array are emitted as
+// soon as each one is complete, no document is built.
+class ResponseParser : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResponseParser(QObject *parent = nullptr);
+
+    void begin(); // Start of a '###* ' block.
+    void feed(QStringView line);
+    void end(); // The ' *###' line, completes the response if the JSON didn't.
+    bool isActive();
+
+signals:
+    void permissionEntry(QString xuid, QString permission);
+    void allowlistEntry(QString name, bool ignoresPlayerLimit);
+    void operatorEntry(QString xuid);
+    void responseComplete(QString command, bool valid);
+
+private:
+    enum Container { ObjectContainer,ArrayContainer };
+    enum TokenState { NoToken,StringToken,StringEscape,StringUnicode,LiteralToken };
+
+    bool active;
+    bool failed;
+    bool complete;
+    QVarLengthArray<Container,8> stack;
+    QStringList keys; // Current key for each open container, empty for arrays.
+    bool expectingKey;
+    TokenState tokenState;
+    QString token;
+    ushort unicodeValue;
+    int unicodeDigits;
+
+    QString command;
+    QString entryXuid;
+    QString entryPermission;
+    QString entryName;
+    bool entryIgnoresPlayerLimit;
+
+    void processChar(QChar c);
+    void handleValue(const QString &text, bool isString);
+    void openContainer(Container container);
+    void closeContainer(Container container);
+    bool inResultArray();
+    void fail(QString reason);
+    void finish();
+};
+
+#endif // RESPONSEPARSER_H
@@ -0,0 +1,177 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "responsivenessprobe.h"
+#include <QSettings>
+#include <algorithm>
+#include <cmath>
+
+#define PROBE_WINDOW 60 // Answers the percentiles are taken over, half an hour at the default interval
+#define PROBE_MIN_SAMPLES 5 // Don't call the server slow on one bad answer
+#define PROBE_RECOVERY_FACTOR 0.8 // p95 must fall this far under the threshold to stop warning
+#define PROBE_STALL_MS 60000
+
+ResponsivenessProbe::ResponsivenessProbe(QObject *parent) : QObject(parent),probeWriting(false),swallowNamesLine(false),stallReported(false),recentHead(0),answered(0),answeredSeconds(0),slow(false)
+{
+    this->clock.start();
+    this->probeTimer.setInterval(getIntervalSeconds()*1000);
+    connect(&this->probeTimer,&QTimer::timeout,this,&ResponsivenessProbe::probe);
+}
+
+QString ResponsivenessProbe::probeCommand()
+{
+    return "list";
+}
+
+void ResponsivenessProbe::setActive(bool active)
+{
+    if (active) {
+        if (!this->probeTimer.isActive()) {
+            this->probeTimer.start();
+        }
+    } else {
+        this->probeTimer.stop();
+        this->listsInFlight.clear();
+        this->swallowNamesLine = false;
+        this->stallReported = false;
+    }
+}
+
+void ResponsivenessProbe::probe()
+{
+    for(int x=0;x<this->listsInFlight.size();x++) {
+        if (this->listsInFlight.at(x)>=0) {
+            // Still waiting on the last one, a second probe would only queue up behind it.
+            qint64 waiting = this->clock.elapsed()-this->listsInFlight.at(x);
+            if (waiting>=PROBE_STALL_MS && !this->stallReported) {
+                this->stallReported = true;
+                emit stalled(waiting);
+            }
+            return;
+        }
+    }
+    this->probeWriting = true;
+    emit probeDue();
+    this->probeWriting = false;
+}
+
+void ResponsivenessProbe::commandWritten(const QString &command)
+{
+    if (command.trimmed().toLower()==probeCommand()) {
+        this->listsInFlight.enqueue(this->probeWriting ? this->clock.elapsed() : -1);
+    }
+}
+
+bool ResponsivenessProbe::handleLine(const QString &line, const QString &cleanLine)
+{
+    if (this->swallowNamesLine) {
+        this->swallowNamesLine = false;
+        if (!line.startsWith("[")) {
+            return true; // The names that follow the count
+        }
+    }
+    if (this->listsInFlight.isEmpty() || !cleanLine.startsWith("There are ") || !cleanLine.contains(" players online")) {
+        return false;
+    }
+    qint64 sent = this->listsInFlight.dequeue();
+    if (sent<0) {
+        return false;
+    }
+    this->swallowNamesLine = true;
+    this->stallReported = false;
+    record(this->clock.elapsed()-sent);
+    return true;
+}
+
+void ResponsivenessProbe::record(qint64 ms)
+{
+    if (this->recent.size()<PROBE_WINDOW) {
+        this->recent.append(ms);
+    } else {
+        this->recent[this->recentHead] = ms;
+        this->recentHead = (this->recentHead+1) % PROBE_WINDOW;
+    }
+    this->answered++;
+    this->answeredSeconds += ms/1000.0;
+    emit probeCompleted(ms);
+
+    if (this->recent.size()<PROBE_MIN_SAMPLES) {
+        return;
+    }
+    qint64 p95 = percentile(0.95);
+    int threshold = getWarningThresholdMs();
+    if (!this->slow && p95>threshold) {
+        this->slow = true;
+        emit slowChanged(true,p95);
+    } else if (this->slow && p95<threshold*PROBE_RECOVERY_FACTOR) {
+        this->slow = false;
+        emit slowChanged(false,p95);
+    }
+}
+
+qint64 ResponsivenessProbe::percentile(double fraction)
+{
+    if (this->recent.isEmpty()) {
+        return -1;
+    }
+    QList<qint64> sorted = this->recent;
+    std::sort(sorted.begin(),sorted.end());
+    int index = qBound(0,(int)std::ceil(fraction*sorted.size())-1,(int)sorted.size()-1);
+    return sorted.at(index);
+}
+
+int ResponsivenessProbe::sampleCount()
+{
+    return this->recent.size();
+}
+
+quint64 ResponsivenessProbe::probeCount()
+{
+    return this->answered;
+}
+
+double ResponsivenessProbe::totalSeconds()
+{
+    return this->answeredSeconds;
+}
+
+bool ResponsivenessProbe::isSlow()
+{
+    return this->slow;
+}
+
+int ResponsivenessProbe::getIntervalSeconds()
+{
+    return QSettings().value("probe/intervalSeconds",30).toInt();
+}
+
+int ResponsivenessProbe::getWarningThresholdMs()
+{
+    return QSettings().value("probe/warningMs",1000).toInt();
+}
+
+void ResponsivenessProbe::setIntervalSeconds(int seconds)
+{
+    if (seconds<1) {
+        return;
+    }
+    QSettings().setValue("probe/intervalSeconds",seconds);
+    this->probeTimer.setInterval(seconds*1000);
+}
+
+void ResponsivenessProbe::setWarningThresholdMs(int ms)
+{
+    if (ms<1) {
+        return;
+    }
+    QSettings().setValue("probe/warningMs",ms);
+}
@@ -0,0 +1,72 @@
+#ifndef RESPONSIVENESSPROBE_H
+#define RESPONSIVENESSPROBE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QList>
+
+// Every so often asks the server for its player list and times the answer. Commands are
+// handled on the server's tick, so a slow answer means a lagging server. The probe's
+// answers are kept off the console, a 'list' typed by someone else is left alone.
+class ResponsivenessProbe : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ResponsivenessProbe(QObject *parent = nullptr);
+
+    static QString probeCommand();
+
+    void setActive(bool active); // Only probe while the server is running.
+    void commandWritten(const QString &command); // Every command written to the server.
+    bool handleLine(const QString &line, const QString &cleanLine); // True if the line answered a probe.
+
+    int getIntervalSeconds();
+    int getWarningThresholdMs();
+    qint64 percentile(double fraction); // Over the recent window in ms, -1 with no samples.
+    int sampleCount(); // In the recent window
+    quint64 probeCount(); // Answered, since starting
+    double totalSeconds(); // Sum of every answered probe
+    bool isSlow();
+
+public slots:
+    void setIntervalSeconds(int seconds);
+    void setWarningThresholdMs(int ms);
+
+signals:
+    void probeDue(); // Write probeCommand() to the server now.
+    void probeCompleted(qint64 ms);
+    void slowChanged(bool slow, qint64 p95Ms);
+    void stalled(qint64 waitingMs); // A probe has gone unanswered for a long time.
+
+private:
+    QTimer probeTimer;
+    QElapsedTimer clock;
+    QQueue<qint64> listsInFlight; // Clock ms a probe was written, -1 for a 'list' someone else sent
+    bool probeWriting;
+    bool swallowNamesLine;
+    bool stallReported;
+    QList<qint64> recent; // Ring of the latest answers in ms
+    int recentHead;
+    quint64 answered;
+    double answeredSeconds;
+    bool slow;
+
+    void probe();
+    void record(qint64 ms);
+};
+
+#endif // RESPONSIVENESSPROBE_H
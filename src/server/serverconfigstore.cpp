@@ -0,0 +1,391 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "serverconfigstore.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <limits>
+
+#include <QDebug>
+
+#define CONFIG_RELOAD_DELAY_MS 250
+#define UNBOUNDED std::numeric_limits<double>::infinity()
+
+// What the dedicated server reads from server.properties. Anything else in the file is
+// kept as a string and not checked.
+static const ServerConfigStore::Schema schemaTable[] = {
+    { "server-name",ServerConfigStore::String,1,UNBOUNDED,{} },
+    { "gamemode",ServerConfigStore::String,0,UNBOUNDED,{ "survival","creative","adventure" } },
+    { "force-gamemode",ServerConfigStore::Boolean,0,0,{} },
+    { "difficulty",ServerConfigStore::String,0,UNBOUNDED,{ "peaceful","easy","normal","hard" } },
+    { "allow-cheats",ServerConfigStore::Boolean,0,0,{} },
+    { "max-players",ServerConfigStore::Integer,1,UNBOUNDED,{} },
+    { "online-mode",ServerConfigStore::Boolean,0,0,{} },
+    { "allow-list",ServerConfigStore::Boolean,0,0,{} },
+    { "white-list",ServerConfigStore::Boolean,0,0,{} },
+    { "server-port",ServerConfigStore::Integer,1,65535,{} },
+    { "server-portv6",ServerConfigStore::Integer,1,65535,{} },
+    { "enable-lan-visibility",ServerConfigStore::Boolean,0,0,{} },
+    { "view-distance",ServerConfigStore::Integer,5,UNBOUNDED,{} },
+    { "tick-distance",ServerConfigStore::Integer,4,12,{} },
+    { "player-idle-timeout",ServerConfigStore::Integer,0,UNBOUNDED,{} },
+    { "max-threads",ServerConfigStore::Integer,0,UNBOUNDED,{} },
+    { "level-name",ServerConfigStore::String,1,UNBOUNDED,{} },
+    { "level-seed",ServerConfigStore::String,0,UNBOUNDED,{} },
+    { "default-player-permission-level",ServerConfigStore::String,0,UNBOUNDED,{ "visitor","member","operator" } },
+    { "texturepack-required",ServerConfigStore::Boolean,0,0,{} },
+    { "content-log-file-enabled",ServerConfigStore::Boolean,0,0,{} },
+    { "compression-threshold",ServerConfigStore::Integer,0,65535,{} },
+    { "compression-algorithm",ServerConfigStore::String,0,UNBOUNDED,{ "zlib","snappy" } },
+    { "server-authoritative-movement",ServerConfigStore::String,0,UNBOUNDED,{ "client-auth","server-auth","server-auth-with-rewind" } },
+    { "player-position-acceptance-threshold",ServerConfigStore::Float,0,UNBOUNDED,{} },
+    { "player-movement-score-threshold",ServerConfigStore::Integer,0,UNBOUNDED,{} },
+    { "player-movement-action-direction-threshold",ServerConfigStore::Float,0,1,{} },
+    { "player-movement-distance-threshold",ServerConfigStore::Float,0,UNBOUNDED,{} },
+    { "player-movement-duration-threshold-in-ms",ServerConfigStore::Integer,0,UNBOUNDED,{} },
+    { "correct-player-movement",ServerConfigStore::Boolean,0,0,{} },
+    { "server-authoritative-block-breaking",ServerConfigStore::Boolean,0,0,{} },
+    { "chat-restriction",ServerConfigStore::String,0,UNBOUNDED,{ "None","Dropped","Disabled" } },
+    { "disable-player-interaction",ServerConfigStore::Boolean,0,0,{} },
+    { "client-side-chunk-generation-enabled",ServerConfigStore::Boolean,0,0,{} },
+    { "block-network-ids-are-hashes",ServerConfigStore::Boolean,0,0,{} },
+    { "disable-persona",ServerConfigStore::Boolean,0,0,{} },
+    { "disable-custom-skins",ServerConfigStore::Boolean,0,0,{} },
+    { "emit-server-telemetry",ServerConfigStore::Boolean,0,0,{} },
+};
+
+ServerConfigStore::ServerConfigStore(QObject *parent) : QObject(parent)
+{
+    this->reloadTimer.setSingleShot(true);
+    this->reloadTimer.setInterval(CONFIG_RELOAD_DELAY_MS);
+    connect(&this->reloadTimer,&QTimer::timeout,this,&ServerConfigStore::reload);
+    connect(&this->watcher,&QFileSystemWatcher::fileChanged,this,[=]() {
+        this->reloadTimer.start();
+    });
+    connect(&this->watcher,&QFileSystemWatcher::directoryChanged,this,[=]() {
+        // Only interesting once the file has been replaced and dropped from the watch.
+        if (!this->watcher.files().contains(this->fileName)) {
+            this->reloadTimer.start();
+        }
+    });
+}
+
+ServerConfigStore::~ServerConfigStore()
+{
+    qDeleteAll(this->ordered);
+}
+
+void ServerConfigStore::setFile(QString fileName)
+{
+    if (fileName==this->fileName) {
+        return;
+    }
+    if (!this->watcher.files().isEmpty()) {
+        this->watcher.removePaths(this->watcher.files());
+    }
+    if (!this->watcher.directories().isEmpty()) {
+        this->watcher.removePaths(this->watcher.directories());
+    }
+    this->fileName = fileName;
+    this->contents.clear();
+    if (!reload()) {
+        clear();
+    }
+}
+
+QString ServerConfigStore::getFile()
+{
+    return this->fileName;
+}
+
+bool ServerConfigStore::reload()
+{
+    if (this->fileName.isEmpty()) {
+        return false;
+    }
+    watch();
+    QFile file(this->fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray contents = file.readAll();
+    file.close();
+    if (!this->contents.isEmpty() && contents==this->contents) {
+        // Our own save, or the file was touched without changing.
+        return true;
+    }
+    this->contents = contents;
+
+    // Comments after a setting are its help.
+    QList<Entry*> ordered;
+    QHash<QString,Entry*> found;
+    QHash<QString,QString> help;
+    QStringList changed;
+    Entry *entry = nullptr;
+    const QStringList lines = QString::fromUtf8(contents).split('\n');
+    for(int x=0;x<lines.size();x++) {
+        QString line = lines.at(x).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        if (line.startsWith('#')) {
+            if (entry) {
+                help[entry->name] += line.mid(1).trimmed()+'\n';
+            }
+            continue;
+        }
+        int equals = line.indexOf('=');
+        if (equals<=0) {
+            continue;
+        }
+        QString name = line.left(equals);
+        if (found.contains(name)) {
+            entry = nullptr; // The server goes by the first one
+            continue;
+        }
+        QString text = line.mid(equals+1);
+        QVariant value = parseValue(name,text);
+        entry = this->byName.value(name);
+        bool isChanged = !entry || entry->value!=value;
+        if (!entry) {
+            entry = new Entry;
+            entry->name = name;
+            entry->type = typeOf(name);
+            entry->possibleValues = possibleValues(name);
+        }
+        if (isChanged) {
+            changed.append(name);
+            QString problem = validate(name,text);
+            if (!problem.isEmpty()) {
+                emit this->invalidValue(name,problem);
+            }
+            entry->newValue = QVariant(); // Changed outside the console, that wins over an unsaved edit
+        }
+        entry->value = value;
+        ordered.append(entry);
+        found.insert(name,entry);
+        help.insert(name,QString());
+    }
+    QSet<QString> valueChanged(changed.constBegin(),changed.constEnd());
+    for(int x=0;x<ordered.size();x++) {
+        Entry *e = ordered.at(x);
+        if (e->help!=help.value(e->name)) {
+            e->help = help.value(e->name);
+            if (!valueChanged.contains(e->name)) {
+                changed.append(e->name);
+            }
+        }
+    }
+    bool reordered = ordered!=this->ordered;
+    for(int x=0;x<this->ordered.size();x++) {
+        Entry *e = this->ordered.at(x);
+        if (!found.contains(e->name)) {
+            changed.append(e->name);
+            delete e;
+        }
+    }
+    this->ordered = ordered;
+    this->byName = found;
+    qDebug()<<"Read"<<this->fileName<<ordered.size()<<"settings"<<changed.size()<<"changed";
+
+    if (reordered || !changed.isEmpty()) {
+        emit this->changed(changed);
+    }
+    return true;
+}
+
+bool ServerConfigStore::save(QString &error)
+{
+    reload(); // Keep anything edited outside the console since it was last read
+
+    QHash<QString,QString> pending;
+    QStringList problems;
+    for(int x=0;x<this->ordered.size();x++) {
+        Entry *e = this->ordered.at(x);
+        if (e->newValue.isNull() || e->newValue.toString()==e->value.toString()) {
+            continue;
+        }
+        QString problem = validate(e->name,e->newValue);
+        if (problem.isEmpty()) {
+            pending.insert(e->name,e->newValue.toString());
+        } else {
+            problems.append(QString("%1 %2").arg(e->name,problem));
+        }
+    }
+    if (!problems.isEmpty()) {
+        error = problems.join(", ");
+        return false;
+    }
+    if (pending.isEmpty()) {
+        return true;
+    }
+
+    // Only the changed lines are rewritten, comments, order and line endings stay as they were.
+    QByteArray out;
+    out.reserve(this->contents.size()+64);
+    QSet<QString> written;
+    int pos = 0;
+    while (pos<this->contents.size()) {
+        int end = this->contents.indexOf('\n',pos);
+        end = (end<0) ? this->contents.size() : end+1;
+        QByteArray line = this->contents.mid(pos,end-pos);
+        pos = end;
+        QByteArray trimmed = line.trimmed();
+        int equals = trimmed.indexOf('=');
+        if (!trimmed.startsWith('#') && equals>0) {
+            QString name = QString::fromUtf8(trimmed.left(equals));
+            if (pending.contains(name) && !written.contains(name)) {
+                QByteArray ending = line.endsWith("\r\n") ? "\r\n" : line.endsWith('\n') ? "\n" : "";
+                line = QString("%1=%2").arg(name,pending.value(name)).toUtf8()+ending;
+                written.insert(name);
+            }
+        }
+        out.append(line);
+    }
+
+    // Written beside the original and renamed over it, the server never sees half a file.
+    QSaveFile file(this->fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out)<0 || !file.commit()) {
+        error = file.errorString();
+        return false;
+    }
+    this->contents = out;
+    watch();
+
+    QStringList names = pending.keys();
+    for(int x=0;x<names.size();x++) {
+        Entry *e = this->byName.value(names.at(x));
+        e->value = parseValue(e->name,pending.value(e->name));
+        e->newValue = QVariant();
+    }
+    qDebug()<<"Saved"<<names.size()<<"changed settings to"<<this->fileName;
+    emit this->changed(names);
+    return true;
+}
+
+QList<ServerConfigStore::Entry *> ServerConfigStore::entries()
+{
+    return this->ordered;
+}
+
+ServerConfigStore::Entry *ServerConfigStore::entry(const QString &name)
+{
+    return this->byName.value(name);
+}
+
+QVariant ServerConfigStore::value(const QString &name)
+{
+    Entry *e = this->byName.value(name);
+    return e ? e->value : QVariant();
+}
+
+const ServerConfigStore::Schema *ServerConfigStore::schema(const QString &name)
+{
+    static const QHash<QString,const Schema*> index = []() {
+        QHash<QString,const Schema*> index;
+        for(const Schema &s : schemaTable) {
+            index.insert(s.name,&s);
+        }
+        return index;
+    }();
+    return index.value(name);
+}
+
+ServerConfigStore::ValueType ServerConfigStore::typeOf(const QString &name)
+{
+    const Schema *s = schema(name);
+    return s ? s->type : String;
+}
+
+QStringList ServerConfigStore::possibleValues(const QString &name)
+{
+    const Schema *s = schema(name);
+    return s ? s->possibleValues : QStringList();
+}
+
+QString ServerConfigStore::validate(const QString &name, const QVariant &value)
+{
+    QString text = value.toString();
+    if (text.contains('\n') || text.contains('\r')) {
+        return tr("must be on one line");
+    }
+    const Schema *s = schema(name);
+    if (!s) {
+        return QString();
+    }
+    bool ok = true;
+    double number = 0;
+    switch (s->type) {
+        case Boolean :
+            return (text=="true" || text=="false") ? QString() : tr("must be true or false");
+        case Integer : number = text.toLongLong(&ok);break;
+        case Float : number = text.toDouble(&ok);break;
+        case String :
+            if (!s->possibleValues.isEmpty() && !s->possibleValues.contains(text)) {
+                return tr("must be one of %1").arg(s->possibleValues.join(", "));
+            }
+            return (text.size()<s->minimum) ? tr("can't be empty") : QString();
+    }
+    if (!ok) {
+        return (s->type==Integer) ? tr("must be a whole number") : tr("must be a number");
+    }
+    if (number<s->minimum || number>s->maximum) {
+        return (s->maximum==UNBOUNDED) ? tr("must be at least %1").arg(s->minimum) : tr("must be between %1 and %2").arg(s->minimum).arg(s->maximum);
+    }
+    return QString();
+}
+
+void ServerConfigStore::watch()
+{
+    // Replacing the file, as editors and our own saves do, drops it from the watch.
+    if (!this->watcher.files().contains(this->fileName) && QFile::exists(this->fileName)) {
+        this->watcher.addPath(this->fileName);
+    }
+    QString folder = QFileInfo(this->fileName).absolutePath();
+    if (!this->watcher.directories().contains(folder) && QFileInfo(folder).isDir()) {
+        this->watcher.addPath(folder);
+    }
+}
+
+void ServerConfigStore::clear()
+{
+    if (this->ordered.isEmpty()) {
+        return;
+    }
+    QStringList names = this->byName.keys();
+    qDeleteAll(this->ordered);
+    this->ordered.clear();
+    this->byName.clear();
+    emit this->changed(names);
+}
+
+QVariant ServerConfigStore::parseValue(const QString &name, const QString &text)
+{
+    // Values that don't parse are kept as text, so they are shown and saved as they were.
+    bool ok = false;
+    switch (typeOf(name)) {
+        case Boolean :
+            return (text=="true" || text=="false") ? QVariant(text=="true") : QVariant(text);
+        case Integer : {
+            int value = text.toInt(&ok);
+            return ok ? QVariant(value) : QVariant(text);
+        }
+        case Float : {
+            double value = text.toDouble(&ok);
+            return ok ? QVariant(value) : QVariant(text);
+        }
+        case String : break;
+    }
+    return QVariant(text);
+}
@@ -0,0 +1,87 @@
+#ifndef SERVERCONFIGSTORE_H
+#define SERVERCONFIGSTORE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QVariant>
+#include <QStringList>
+#include <QTimer>
+#include <QFileSystemWatcher>
+
+// The settings in server.properties, typed and checked against a schema of the ones the
+// server understands. Entries are looked up by name in a hash and kept across reloads, so
+// a reload only touches the ones that changed. Saving rewrites just the changed lines and
+// replaces the file in one go. The file is watched, edits made outside the console are
+// picked up as they happen.
+class ServerConfigStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ServerConfigStore(QObject *parent = nullptr);
+    ~ServerConfigStore();
+
+    enum ValueType { String,Integer,Float,Boolean };
+
+    class Schema {
+    public:
+        QString name;
+        ValueType type;
+        double minimum; // The shortest allowed text for strings
+        double maximum;
+        QStringList possibleValues;
+    };
+
+    class Entry {
+    public:
+        QString name;
+        ValueType type;
+        QVariant value;
+        QVariant newValue; // Waiting to be saved, null if there's no change
+        QStringList possibleValues;
+        QString help;
+    };
+
+    void setFile(QString fileName);
+    QString getFile();
+    bool reload(); // False if the file can't be read, the entries are left as they were
+    bool save(QString &error); // Checks and writes every pending newValue, nothing is written if any are invalid
+    QList<Entry*> entries(); // In file order
+    Entry *entry(const QString &name); // nullptr if the file doesn't have it
+    QVariant value(const QString &name);
+
+    static const Schema *schema(const QString &name); // nullptr for settings the console doesn't know
+    static ValueType typeOf(const QString &name);
+    static QStringList possibleValues(const QString &name);
+    static QString validate(const QString &name, const QVariant &value); // Empty if it's allowed, otherwise why not
+
+signals:
+    void changed(QStringList names); // Values, help, or which settings there are, including the first read
+    void invalidValue(QString name, QString problem); // Something in the file that the server won't like
+
+private:
+    QString fileName;
+    QByteArray contents; // As last read or written
+    QList<Entry*> ordered;
+    QHash<QString,Entry*> byName;
+    QFileSystemWatcher watcher;
+    QTimer reloadTimer; // Editors tend to write in a few steps
+
+    void watch();
+    void clear();
+    static QVariant parseValue(const QString &name, const QString &text);
+};
+
+#endif // SERVERCONFIGSTORE_H
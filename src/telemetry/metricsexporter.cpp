@@ -0,0 +1,322 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "metricsexporter.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSettings>
+#include <QMutexLocker>
+#include <QDebug>
+
+#define METRICS_SNAPSHOT_MS 1000
+#define METRICS_MAX_REQUEST_BYTES 8192
+
+QByteArray MetricsSnapshot::get()
+{
+    QMutexLocker locker(&this->lock);
+    return this->text;
+}
+
+void MetricsSnapshot::set(QByteArray text)
+{
+    QMutexLocker locker(&this->lock);
+    this->text = text;
+}
+
+MetricsHttpServer::MetricsHttpServer(MetricsSnapshot *snapshot) : QObject(nullptr),snapshot(snapshot),tcpServer(nullptr)
+{
+}
+
+void MetricsHttpServer::listen(int port)
+{
+    stop();
+    this->tcpServer = new QTcpServer(this);
+    connect(this->tcpServer,&QTcpServer::newConnection,this,&MetricsHttpServer::handleConnection);
+    if (this->tcpServer->listen(QHostAddress::LocalHost,port)) {
+        qDebug()<<"Serving metrics on localhost port"<<port;
+        emit listenStateChanged(true,QString());
+    } else {
+        emit listenStateChanged(false,this->tcpServer->errorString());
+        stop();
+    }
+}
+
+void MetricsHttpServer::stop()
+{
+    if (this->tcpServer) {
+        this->tcpServer->close();
+        this->tcpServer->deleteLater();
+        this->tcpServer = nullptr;
+        emit listenStateChanged(false,QString());
+    }
+}
+
+void MetricsHttpServer::handleConnection()
+{
+    while (this->tcpServer && this->tcpServer->hasPendingConnections()) {
+        QTcpSocket *socket = this->tcpServer->nextPendingConnection();
+        connect(socket,&QTcpSocket::disconnected,socket,&QObject::deleteLater);
+        connect(socket,&QTcpSocket::readyRead,socket,[=]() {
+            // Only the request line matters, but wait for the end of the headers before answering.
+            QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+            if (request.size()>METRICS_MAX_REQUEST_BYTES) {
+                socket->abort();
+                return;
+            }
+            socket->setProperty("request",request);
+            if (!request.contains("\r\n\r\n")) {
+                return;
+            }
+
+            QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+            QByteArray path = requestLine.size()>1 ? requestLine.at(1) : QByteArray();
+            path = path.left(path.indexOf('?')>=0 ? path.indexOf('?') : path.size());
+
+            QByteArray status;
+            QByteArray contentType;
+            QByteArray body;
+            if (requestLine.first()!="GET") {
+                status = "405 Method Not Allowed";
+                contentType = "text/plain; charset=utf-8";
+                body = "Only GET is supported.\n";
+            } else if (path=="/metrics") {
+                status = "200 OK";
+                contentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+                body = this->snapshot->get();
+            } else {
+                status = "404 Not Found";
+                contentType = "text/plain; charset=utf-8";
+                body = "Metrics are at /metrics\n";
+            }
+            socket->write("HTTP/1.1 "+status+"\r\nContent-Type: "+contentType+"\r\nContent-Length: "+QByteArray::number(body.size())+"\r\nConnection: close\r\n\r\n");
+            socket->write(body);
+            socket->disconnectFromHost();
+        });
+    }
+}
+
+MetricsExporter::MetricsExporter(BedrockServer *server, ProcessTelemetry *telemetry, QObject *parent)
+    : QObject(parent),server(server),telemetry(telemetry),knownOperators(0),knownMembers(0),knownVisitors(0),outputLines(0),serverStarts(0),serverRestarts(0),backups(0),backupFailures(0),backupSecondsTotal(0)
+{
+    this->httpServer = new MetricsHttpServer(&this->snapshot);
+    this->httpServer->moveToThread(&this->httpThread);
+    connect(&this->httpThread,&QThread::finished,this->httpServer,&QObject::deleteLater);
+    connect(this,&MetricsExporter::listenRequested,this->httpServer,&MetricsHttpServer::listen);
+    connect(this,&MetricsExporter::stopRequested,this->httpServer,&MetricsHttpServer::stop);
+    connect(this->httpServer,&MetricsHttpServer::listenStateChanged,this,&MetricsExporter::listenStateChanged);
+    this->httpThread.setObjectName("MetricsHttpServer");
+    this->httpThread.start();
+
+    connect(this->server,&BedrockServer::serverStateChanged,this,[=](BedrockServer::ServerState state) {
+        if (state==BedrockServer::ServerStartup) {
+            this->serverStarts++;
+        } else if (state==BedrockServer::ServerRestarting) {
+            this->serverRestarts++;
+        }
+    });
+    connect(this->server,&BedrockServer::serverPermissionList,this,[=](QStringList ops, QStringList members, QStringList visitors) {
+        this->knownOperators = ops.size();
+        this->knownMembers = members.size();
+        this->knownVisitors = visitors.size();
+    });
+    // Timings are updated several times during a backup, only the end of one is counted.
+    connect(this->server,&BedrockServer::backupFinished,this,[=]() {
+        BedrockServer::BackupTimings timings = this->server->getLastBackupTimings();
+        this->backups++;
+        if (timings.totalMs>=0) {
+            this->backupSecondsTotal += timings.totalMs/1000.0;
+        }
+    });
+    connect(this->server,&BedrockServer::backupFailed,this,[=]() {
+        this->backupFailures++;
+    });
+
+    connect(this->server,&BedrockServer::serverLogLine,this,[=]() {
+        this->outputLines++;
+    });
+
+    this->snapshotTimer.setInterval(METRICS_SNAPSHOT_MS);
+    connect(&this->snapshotTimer,&QTimer::timeout,this,[=]() {
+        this->updateSnapshot();
+    });
+
+    if (getEnabled()) {
+        setEnabled(true);
+    }
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    this->httpThread.quit();
+    this->httpThread.wait();
+}
+
+bool MetricsExporter::getEnabled()
+{
+    return QSettings().value("metrics/enabled",false).toBool();
+}
+
+int MetricsExporter::getPort()
+{
+    return QSettings().value("metrics/port",9469).toInt();
+}
+
+void MetricsExporter::setEnabled(bool state)
+{
+    QSettings().setValue("metrics/enabled",state);
+    if (state) {
+        updateSnapshot();
+        this->snapshotTimer.start();
+        emit listenRequested(getPort());
+    } else {
+        this->snapshotTimer.stop();
+        emit stopRequested();
+    }
+}
+
+void MetricsExporter::setPort(int port)
+{
+    if (port<1 || port>65535) {
+        return;
+    }
+    QSettings().setValue("metrics/port",port);
+    if (getEnabled()) {
+        emit listenRequested(port);
+    }
+}
+
+void MetricsExporter::updateSnapshot()
+{
+    QByteArray out;
+    auto family = [&](const char *name, const char *type, const char *help) {
+        out += QByteArray("# TYPE ")+name+" "+type+"\n# HELP "+name+" "+help+"\n";
+    };
+    auto sample = [&](QByteArray name, double value) {
+        out += name+" "+QByteArray::number(value,'g',12)+"\n";
+    };
+
+    family("mcbc_server_state","stateset","Current state of the bedrock server.");
+    BedrockServer::ServerState current = this->server->GetCurrentState();
+    const QList<QPair<BedrockServer::ServerState,const char*>> states = {
+        {BedrockServer::ServerLoading,"loading"},{BedrockServer::ServerStartup,"startup"},{BedrockServer::ServerRunning,"running"},
+        {BedrockServer::ServerNotRunning,"not_running"},{BedrockServer::ServerStopped,"stopped"},{BedrockServer::ServerShutdown,"shutdown"},
+        {BedrockServer::ServerRestarting,"restarting"}
+    };
+    for(const auto &state : states) {
+        sample(QByteArray("mcbc_server_state{mcbc_server_state=\"")+state.second+"\"}",state.first==current ? 1 : 0);
+    }
+    family("mcbc_server_starts","counter","Times the server has started.");
+    sample("mcbc_server_starts_total",this->serverStarts);
+    family("mcbc_server_restarts","counter","Times the server was restarted after exiting unexpectedly.");
+    sample("mcbc_server_restarts_total",this->serverRestarts);
+
+    LifecycleTimeline *lifecycle = this->server->getLifecycleTimeline();
+    LifecycleTimeline::Timing start = lifecycle->lastStart();
+    family("mcbc_last_start_phase_seconds","gauge","Time from spawning the server process to each phase of the latest start.");
+    const QList<QPair<LifecycleTimeline::Phase,const char*>> startPhases = {
+        {LifecycleTimeline::FirstLine,"first_output"},{LifecycleTimeline::OpeningLevel,"opening_level"},{LifecycleTimeline::Started,"started"}
+    };
+    for(const auto &phase : startPhases) {
+        if (start.ms[phase.first]>=0) {
+            sample(QByteArray("mcbc_last_start_phase_seconds{phase=\"")+phase.second+"\"}",start.ms[phase.first]/1000.0);
+        }
+    }
+    family("mcbc_last_shutdown_seconds","gauge","Time from sending stop to the server process exiting, for the latest stop.");
+    if (lifecycle->lastShutdownMs()>=0) {
+        sample("mcbc_last_shutdown_seconds",lifecycle->lastShutdownMs()/1000.0);
+    }
+
+    family("mcbc_players_online","gauge","Players connected now.");
+    sample("mcbc_players_online",this->server->onlinePlayerCount());
+    family("mcbc_operators_online","gauge","Connected players with operator permission.");
+    sample("mcbc_operators_online",this->server->onlineOperatorCount());
+    family("mcbc_players_max","gauge","max-players from server.properties.");
+    sample("mcbc_players_max",this->server->maxPlayers());
+    family("mcbc_permission_entries","gauge","Entries in permissions.json by level.");
+    sample("mcbc_permission_entries{level=\"operator\"}",this->knownOperators);
+    sample("mcbc_permission_entries{level=\"member\"}",this->knownMembers);
+    sample("mcbc_permission_entries{level=\"visitor\"}",this->knownVisitors);
+    family("mcbc_permission_row_changes","counter","Player list rows added, removed or moved by permission list refreshes.");
+    sample("mcbc_permission_row_changes_total",this->server->permissionRowChanges());
+
+    BedrockServer::BackupTimings timings = this->server->getLastBackupTimings();
+    family("mcbc_backups","counter","Backups completed.");
+    sample("mcbc_backups_total",this->backups);
+    family("mcbc_backup_failures","counter","Backups that failed.");
+    sample("mcbc_backup_failures_total",this->backupFailures);
+    family("mcbc_backup_seconds","counter","Total time spent on completed backups.");
+    sample("mcbc_backup_seconds_total",this->backupSecondsTotal);
+    family("mcbc_last_backup_phase_seconds","gauge","How long each phase of the latest backup took.");
+    const QList<QPair<const char*,qint64>> phases = {
+        {"prepare",timings.prepareMs},{"copy",timings.copyMs},{"compress",timings.compressMs},{"total",timings.totalMs}
+    };
+    for(const auto &phase : phases) {
+        if (phase.second>=0) {
+            sample(QByteArray("mcbc_last_backup_phase_seconds{phase=\"")+phase.first+"\"}",phase.second/1000.0);
+        }
+    }
+    family("mcbc_last_backup_hold_window_seconds","gauge","Time world saves were held for during the latest backup.");
+    if (timings.holdWindowMs>=0) {
+        sample("mcbc_last_backup_hold_window_seconds",timings.holdWindowMs/1000.0);
+    }
+    family("mcbc_last_backup_bytes","gauge","Size of the latest backup.");
+    sample("mcbc_last_backup_bytes{stage=\"copied\"}",timings.copiedBytes);
+    sample("mcbc_last_backup_bytes{stage=\"compressed\"}",timings.zipBytes);
+
+    OutputThrottle *throttle = this->server->getOutputThrottle();
+    family("mcbc_output_lines","counter","Lines of server output.");
+    sample("mcbc_output_lines_total",this->outputLines);
+    family("mcbc_output_line_rate","gauge","Current server output rate, lines per second.");
+    sample("mcbc_output_line_rate",throttle->currentLineRate());
+    family("mcbc_output_throttled_lines","counter","Lines kept off the console during output floods.");
+    sample("mcbc_output_throttled_lines_total{action=\"dropped\"}",throttle->droppedCount());
+    sample("mcbc_output_throttled_lines_total{action=\"summarised\"}",throttle->summarizedCount());
+
+    CommandQueue *commands = this->server->getCommandQueue();
+    family("mcbc_commands","counter","Commands handled by the command queue.");
+    sample("mcbc_commands_total{outcome=\"sent\"}",commands->sentCount());
+    sample("mcbc_commands_total{outcome=\"merged\"}",commands->mergedCount());
+    sample("mcbc_commands_total{outcome=\"dropped\"}",commands->droppedCount());
+    family("mcbc_commands_pending","gauge","Commands waiting in the queue.");
+    sample("mcbc_commands_pending",commands->pendingCount());
+
+    ResponsivenessProbe *probe = this->server->getResponsivenessProbe();
+    family("mcbc_server_response_seconds","summary","Time the server takes to answer a 'list' probe, quantiles over the recent probes.");
+    if (probe->sampleCount()>0) {
+        const double quantiles[] = { 0.5,0.95,0.99 };
+        for(double quantile : quantiles) {
+            sample(QByteArray("mcbc_server_response_seconds{quantile=\"")+QByteArray::number(quantile)+"\"}",probe->percentile(quantile)/1000.0);
+        }
+    }
+    sample("mcbc_server_response_seconds_count",probe->probeCount());
+    sample("mcbc_server_response_seconds_sum",probe->totalSeconds());
+    family("mcbc_server_slow","gauge","1 while the server's 95th percentile response time is over the warning threshold.");
+    sample("mcbc_server_slow",probe->isSlow() ? 1 : 0);
+
+    if (ProcessTelemetry::isSupported()) {
+        const QList<QPair<ProcessTelemetry::Metric,const char*>> metrics = {
+            {ProcessTelemetry::CpuPercent,"mcbc_process_cpu_percent"},{ProcessTelemetry::ResidentMiB,"mcbc_process_resident_mebibytes"},
+            {ProcessTelemetry::ProportionalMiB,"mcbc_process_pss_mebibytes"},{ProcessTelemetry::Threads,"mcbc_process_threads"},
+            {ProcessTelemetry::ReadKiBPerSecond,"mcbc_process_read_kibibytes_per_second"},{ProcessTelemetry::WriteKiBPerSecond,"mcbc_process_write_kibibytes_per_second"}
+        };
+        for(const auto &metric : metrics) {
+            const TelemetrySeries &series = this->telemetry->series(metric.first);
+            family(metric.second,"gauge",ProcessTelemetry::metricName(metric.first).toUtf8().constData());
+            if (!series.isEmpty() && this->server->getServerProcessId()!=0) {
+                sample(metric.second,series.last());
+            }
+        }
+    }
+
+    out += "# EOF\n";
+    this->snapshot.set(out);
+}
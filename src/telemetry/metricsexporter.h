@@ -0,0 +1,100 @@
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QMutex>
+#include <server/bedrockserver.h>
+#include "processtelemetry.h"
+
+class QTcpServer;
+
+// The latest exposition text, written by the GUI thread and read by the HTTP thread.
+class MetricsSnapshot
+{
+public:
+    QByteArray get();
+    void set(QByteArray text);
+
+private:
+    QMutex lock;
+    QByteArray text;
+};
+
+// Answers GET /metrics on its own thread, straight from the snapshot.
+class MetricsHttpServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsHttpServer(MetricsSnapshot *snapshot);
+
+public slots:
+    void listen(int port);
+    void stop();
+
+signals:
+    void listenStateChanged(bool listening, QString error);
+
+private:
+    MetricsSnapshot *snapshot;
+    QTcpServer *tcpServer;
+
+    void handleConnection();
+};
+
+// Serves console and server metrics in OpenMetrics format for Prometheus and friends.
+// Off by default, and only ever bound to localhost.
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsExporter(BedrockServer *server, ProcessTelemetry *telemetry, QObject *parent = nullptr);
+    ~MetricsExporter();
+
+    bool getEnabled();
+    int getPort();
+
+public slots:
+    void setEnabled(bool state);
+    void setPort(int port);
+
+signals:
+    void listenRequested(int port);
+    void stopRequested();
+    void listenStateChanged(bool listening, QString error);
+
+private:
+    BedrockServer *server;
+    ProcessTelemetry *telemetry;
+    QThread httpThread;
+    MetricsHttpServer *httpServer;
+    MetricsSnapshot snapshot;
+    QTimer snapshotTimer;
+
+    int knownOperators;
+    int knownMembers;
+    int knownVisitors;
+    quint64 outputLines;
+    quint64 serverStarts;
+    quint64 serverRestarts;
+    quint64 backups;
+    quint64 backupFailures;
+    double backupSecondsTotal;
+
+    void updateSnapshot();
+};
+
+#endif // METRICSEXPORTER_H
@@ -0,0 +1,137 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "metricshistory.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#define HISTORY_SAMPLE_MS 10000
+#define HISTORY_WORLD_SIZE_MS (10*60*1000)
+
+MetricsHistory::MetricsHistory(BedrockServer *server, ProcessTelemetry *telemetry, QObject *parent)
+    : QObject(parent),server(server),telemetry(telemetry)
+{
+    this->store = new TimeSeriesStore(QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("history"),this);
+
+    connect(this->server,&BedrockServer::serverStateChanged,this,[=](BedrockServer::ServerState state) {
+        if (state==BedrockServer::ServerRunning) {
+            recordWorldSize();
+        }
+    });
+    connect(this->server->getResponsivenessProbe(),&ResponsivenessProbe::probeCompleted,this,[=](qint64 ms) {
+        this->store->record(seriesKey(ServerResponse),ms);
+    });
+    connect(this->server->getLifecycleTimeline(),&LifecycleTimeline::startTimed,this,[=](qint64 totalMs) {
+        this->store->record(seriesKey(StartupTime),totalMs/1000.0);
+    });
+    connect(this->server->getLifecycleTimeline(),&LifecycleTimeline::stopTimed,this,[=](qint64 totalMs) {
+        this->store->record(seriesKey(ShutdownTime),totalMs/1000.0);
+    });
+    // Once per backup, timings are updated several times during one and a failed zip has no size.
+    connect(this->server,&BedrockServer::backupFinished,this,[=]() {
+        BedrockServer::BackupTimings timings = this->server->getLastBackupTimings();
+        if (timings.totalMs>=0) {
+            this->store->record(seriesKey(BackupDuration),timings.totalMs/1000.0);
+            this->store->record(seriesKey(BackupSize),timings.zipBytes/(1024.0*1024.0));
+        }
+    });
+
+    this->sampleTimer.setInterval(HISTORY_SAMPLE_MS);
+    connect(&this->sampleTimer,&QTimer::timeout,this,[=]() {
+        this->store->record(seriesKey(PlayersOnline),this->server->onlinePlayerCount());
+        if (this->server->getServerProcessId()==0) {
+            return;
+        }
+        const TelemetrySeries &memory = this->telemetry->series(ProcessTelemetry::ResidentMiB);
+        const TelemetrySeries &cpu = this->telemetry->series(ProcessTelemetry::CpuPercent);
+        if (!memory.isEmpty()) {
+            this->store->record(seriesKey(ServerMemory),memory.last());
+        }
+        if (!cpu.isEmpty()) {
+            this->store->record(seriesKey(ServerCpu),cpu.last());
+        }
+    });
+    this->sampleTimer.start();
+
+    this->worldSizeTimer.setInterval(HISTORY_WORLD_SIZE_MS);
+    connect(&this->worldSizeTimer,&QTimer::timeout,this,[=]() {
+        this->recordWorldSize();
+    });
+    this->worldSizeTimer.start();
+}
+
+QString MetricsHistory::seriesKey(Series series)
+{
+    switch (series) {
+    case PlayersOnline : return "players";
+    case ServerMemory : return "memory";
+    case ServerCpu : return "cpu";
+    case ServerResponse : return "response";
+    case StartupTime : return "startup";
+    case ShutdownTime : return "shutdown";
+    case WorldSize : return "worldsize";
+    case BackupDuration : return "backupduration";
+    case BackupSize : return "backupsize";
+    default : return QString();
+    }
+}
+
+QString MetricsHistory::seriesName(Series series)
+{
+    switch (series) {
+    case PlayersOnline : return tr("Players online");
+    case ServerMemory : return tr("Server memory");
+    case ServerCpu : return tr("Server CPU");
+    case ServerResponse : return tr("Server response time");
+    case StartupTime : return tr("Server start time");
+    case ShutdownTime : return tr("Server stop time");
+    case WorldSize : return tr("World size");
+    case BackupDuration : return tr("Backup duration");
+    case BackupSize : return tr("Backup size");
+    default : return QString();
+    }
+}
+
+QString MetricsHistory::seriesUnit(Series series)
+{
+    switch (series) {
+    case PlayersOnline : return tr("players");
+    case ServerCpu : return tr("%","Percent of one CPU core");
+    case ServerResponse : return tr("ms","Milliseconds");
+    case StartupTime :
+    case ShutdownTime :
+    case BackupDuration : return tr("s","Seconds");
+    default : return tr("MiB");
+    }
+}
+
+QList<TimeSeriesPoint> MetricsHistory::query(Series series, QDateTime from, QDateTime to, int maxPoints)
+{
+    return this->store->query(seriesKey(series),from.toSecsSinceEpoch(),to.toSecsSinceEpoch(),maxPoints);
+}
+
+void MetricsHistory::recordWorldSize()
+{
+    QString folder = this->server->getWorldFolder();
+    if (folder.isEmpty() || !QDir(folder).exists()) {
+        return;
+    }
+    qint64 bytes = 0;
+    QDirIterator files(folder,QDir::Files|QDir::Hidden,QDirIterator::Subdirectories);
+    while (files.hasNext()) {
+        files.next();
+        bytes += files.fileInfo().size();
+    }
+    this->store->record(seriesKey(WorldSize),bytes/(1024.0*1024.0));
+}
@@ -0,0 +1,48 @@
+#ifndef METRICSHISTORY_H
+#define METRICSHISTORY_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QTimer>
+#include <QDateTime>
+#include <server/bedrockserver.h>
+#include "processtelemetry.h"
+#include "timeseriesstore.h"
+
+// Records players online, server memory and CPU, world size and backups into a
+// TimeSeriesStore so they can be charted over weeks and months.
+class MetricsHistory : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MetricsHistory(BedrockServer *server, ProcessTelemetry *telemetry, QObject *parent = nullptr);
+
+    enum Series { PlayersOnline,ServerMemory,ServerCpu,ServerResponse,StartupTime,ShutdownTime,WorldSize,BackupDuration,BackupSize,SeriesCount };
+
+    static QString seriesName(Series series);
+    static QString seriesUnit(Series series);
+    QList<TimeSeriesPoint> query(Series series, QDateTime from, QDateTime to, int maxPoints);
+
+private:
+    BedrockServer *server;
+    ProcessTelemetry *telemetry;
+    TimeSeriesStore *store;
+    QTimer sampleTimer;
+    QTimer worldSizeTimer;
+
+    static QString seriesKey(Series series);
+    void recordWorldSize();
+};
+
+#endif // METRICSHISTORY_H
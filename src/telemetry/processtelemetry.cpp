@@ -0,0 +1,180 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "processtelemetry.h"
+#include <QSettings>
+#include <QFile>
+#include <QDebug>
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+ProcessTelemetry::ProcessTelemetry(BedrockServer *server, QObject *parent)
+    : QObject(parent),server(server),sampledPid(0),previousCpuTicks(-1),previousReadBytes(-1),previousWriteBytes(-1)
+{
+    if (!isSupported()) {
+        return;
+    }
+    this->sampleTimer.setInterval(getSampleInterval());
+    connect(&this->sampleTimer,&QTimer::timeout,this,[=]() {
+        this->sample();
+    });
+    this->sampleTimer.start();
+}
+
+bool ProcessTelemetry::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+QString ProcessTelemetry::metricName(Metric metric)
+{
+    switch (metric) {
+    case CpuPercent : return tr("CPU");
+    case ResidentMiB : return tr("Memory");
+    case ProportionalMiB : return tr("Memory (PSS)");
+    case Threads : return tr("Threads");
+    case ReadKiBPerSecond : return tr("Disk read");
+    case WriteKiBPerSecond : return tr("Disk write");
+    default : return QString();
+    }
+}
+
+QString ProcessTelemetry::metricUnit(Metric metric)
+{
+    switch (metric) {
+    case CpuPercent : return tr("%","Percent of one CPU core");
+    case ResidentMiB :
+    case ProportionalMiB : return tr("MiB");
+    case ReadKiBPerSecond :
+    case WriteKiBPerSecond : return tr("KiB/s");
+    default : return QString();
+    }
+}
+
+const TelemetrySeries &ProcessTelemetry::series(Metric metric)
+{
+    return this->metrics[metric];
+}
+
+int ProcessTelemetry::getSampleInterval()
+{
+    return QSettings().value("telemetry/sampleIntervalMs",1000).toInt();
+}
+
+void ProcessTelemetry::setSampleInterval(int ms)
+{
+    if (ms<100) {
+        return;
+    }
+    QSettings().setValue("telemetry/sampleIntervalMs",ms);
+    this->sampleTimer.setInterval(ms);
+}
+
+void ProcessTelemetry::sample()
+{
+#ifdef Q_OS_LINUX
+    qint64 pid = this->server->getServerProcessId();
+    if (pid!=this->sampledPid) {
+        // New process, or none, rates need a fresh starting point.
+        this->sampledPid = pid;
+        this->previousCpuTicks = -1;
+        this->previousReadBytes = -1;
+        this->previousWriteBytes = -1;
+    }
+    if (pid==0) {
+        return;
+    }
+
+    double seconds = this->sinceLastSample.isValid() ? this->sinceLastSample.restart()/1000.0 : 0;
+    if (!this->sinceLastSample.isValid()) {
+        this->sinceLastSample.start();
+    }
+
+    // utime and stime are fields 14 and 15, counting from after the ')' that closes the
+    // command name (which can hold spaces) they're at 11 and 12.
+    QByteArray stat = readProcFile(pid,"stat");
+    int close = stat.lastIndexOf(')');
+    if (close<0) {
+        return;
+    }
+    QList<QByteArray> fields = stat.mid(close+2).split(' ');
+    if (fields.size()>12) {
+        qint64 ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+        if (this->previousCpuTicks>=0 && seconds>0) {
+            static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+            this->metrics[CpuPercent].add((ticks-this->previousCpuTicks)*100.0/ticksPerSecond/seconds);
+        }
+        this->previousCpuTicks = ticks;
+    }
+
+    QByteArray status = readProcFile(pid,"status");
+    qint64 value = statusValue(status,"VmRSS");
+    if (value>=0) {
+        this->metrics[ResidentMiB].add(value/1024.0);
+    }
+    value = statusValue(status,"Threads");
+    if (value>=0) {
+        this->metrics[Threads].add(value);
+    }
+
+    // Needs Linux 4.14, older kernels just don't get this one.
+    value = statusValue(readProcFile(pid,"smaps_rollup"),"Pss");
+    if (value>=0) {
+        this->metrics[ProportionalMiB].add(value/1024.0);
+    }
+
+    QByteArray io = readProcFile(pid,"io");
+    qint64 readBytes = statusValue(io,"read_bytes");
+    qint64 writeBytes = statusValue(io,"write_bytes");
+    if (readBytes>=0 && this->previousReadBytes>=0 && seconds>0) {
+        this->metrics[ReadKiBPerSecond].add((readBytes-this->previousReadBytes)/1024.0/seconds);
+    }
+    if (writeBytes>=0 && this->previousWriteBytes>=0 && seconds>0) {
+        this->metrics[WriteKiBPerSecond].add((writeBytes-this->previousWriteBytes)/1024.0/seconds);
+    }
+    this->previousReadBytes = readBytes;
+    this->previousWriteBytes = writeBytes;
+
+    emit sampled();
+#endif
+}
+
+QByteArray ProcessTelemetry::readProcFile(qint64 pid, const char *name)
+{
+    // /proc files report a size of 0, so read until there's nothing left rather than by size.
+    QFile file(QString("/proc/%1/%2").arg(pid).arg(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+qint64 ProcessTelemetry::statusValue(const QByteArray &file, const char *key)
+{
+    QByteArray search = QByteArray("\n")+key+":";
+    int idx = file.startsWith(QByteArray(key)+":") ? 0 : file.indexOf(search);
+    if (idx<0) {
+        return -1;
+    }
+    idx = file.indexOf(':',idx)+1;
+    int end = file.indexOf('\n',idx);
+    QByteArray value = file.mid(idx,end<0 ? -1 : end-idx).trimmed();
+    // 'VmRSS:	  123456 kB', the unit is always kB for the ones we read.
+    bool ok = false;
+    qint64 ret = value.split(' ').first().toLongLong(&ok);
+    return ok ? ret : -1;
+}
@@ -0,0 +1,59 @@
+#ifndef PROCESSTELEMETRY_H
+#define PROCESSTELEMETRY_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <server/bedrockserver.h>
+#include "telemetryseries.h"
+
+// Samples the bedrock_server process's CPU, memory, threads and disk IO from /proc.
+// Only Linux has /proc, elsewhere isSupported() is false and nothing is sampled.
+class ProcessTelemetry : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProcessTelemetry(BedrockServer *server, QObject *parent = nullptr);
+
+    enum Metric { CpuPercent,ResidentMiB,ProportionalMiB,Threads,ReadKiBPerSecond,WriteKiBPerSecond,MetricCount };
+
+    static bool isSupported();
+    static QString metricName(Metric metric);
+    static QString metricUnit(Metric metric);
+    const TelemetrySeries &series(Metric metric);
+    int getSampleInterval();
+
+public slots:
+    void setSampleInterval(int ms);
+
+signals:
+    void sampled();
+
+private:
+    BedrockServer *server;
+    QTimer sampleTimer;
+    TelemetrySeries metrics[MetricCount];
+    qint64 sampledPid;
+    qint64 previousCpuTicks;
+    qint64 previousReadBytes;
+    qint64 previousWriteBytes;
+    QElapsedTimer sinceLastSample;
+
+    void sample();
+    static QByteArray readProcFile(qint64 pid, const char *name);
+    static qint64 statusValue(const QByteArray &file, const char *key); // The number after 'key:', -1 if missing
+};
+
+#endif // PROCESSTELEMETRY_H
@@ -0,0 +1,104 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "telemetryseries.h"
+
+// At the default one second sample this is five minutes, an hour and a day.
+#define SERIES_RECENT_POINTS 300
+#define SERIES_HOUR_POINTS 360
+#define SERIES_HOUR_FACTOR 10
+#define SERIES_DAY_POINTS 1440
+#define SERIES_DAY_FACTOR 6
+
+TelemetrySeries::TelemetrySeries() : lastValue(0)
+{
+    this->rings[Recent].capacity = SERIES_RECENT_POINTS;
+    this->rings[Hour].capacity = SERIES_HOUR_POINTS;
+    this->rings[Hour].factor = SERIES_HOUR_FACTOR;
+    this->rings[Day].capacity = SERIES_DAY_POINTS;
+    this->rings[Day].factor = SERIES_DAY_FACTOR;
+    for(Ring &ring : this->rings) {
+        ring.data.resize(ring.capacity);
+    }
+}
+
+void TelemetrySeries::add(double value)
+{
+    this->lastValue = value;
+    this->rings[Recent].add(value);
+
+    // Feed the averages down the chain.
+    for(int x=1;x<ResolutionCount;x++) {
+        Ring &ring = this->rings[x];
+        ring.pendingSum += value;
+        ring.pendingCount++;
+        if (ring.pendingCount<ring.factor) {
+            break;
+        }
+        value = ring.pendingSum/ring.pendingCount;
+        ring.pendingSum = 0;
+        ring.pendingCount = 0;
+        ring.add(value);
+    }
+}
+
+void TelemetrySeries::clear()
+{
+    for(Ring &ring : this->rings) {
+        ring.head = 0;
+        ring.count = 0;
+        ring.pendingSum = 0;
+        ring.pendingCount = 0;
+    }
+    this->lastValue = 0;
+}
+
+bool TelemetrySeries::isEmpty() const
+{
+    return this->rings[Recent].count==0;
+}
+
+double TelemetrySeries::last() const
+{
+    return this->lastValue;
+}
+
+QList<double> TelemetrySeries::values(Resolution resolution) const
+{
+    const Ring &ring = this->rings[resolution];
+    QList<double> ret;
+    ret.reserve(ring.count);
+    for(int x=0;x<ring.count;x++) {
+        ret.append(ring.data.at((ring.head+x) % ring.capacity));
+    }
+    return ret;
+}
+
+int TelemetrySeries::samplesPerPoint(Resolution resolution) const
+{
+    int samples = 1;
+    for(int x=1;x<=resolution;x++) {
+        samples *= this->rings[x].factor;
+    }
+    return samples;
+}
+
+void TelemetrySeries::Ring::add(double value)
+{
+    if (this->count<this->capacity) {
+        this->data[(this->head+this->count) % this->capacity] = value;
+        this->count++;
+    } else {
+        this->data[this->head] = value;
+        this->head = (this->head+1) % this->capacity;
+    }
+}
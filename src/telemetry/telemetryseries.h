@@ -0,0 +1,53 @@
+#ifndef TELEMETRYSERIES_H
+#define TELEMETRYSERIES_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QList>
+
+// Samples for one metric at a few resolutions. Every sample goes into the first ring,
+// each following ring gets the average of every 'factor' values from the one before, so
+// the newest data is detailed and older data is kept as averages in bounded memory.
+class TelemetrySeries
+{
+public:
+    TelemetrySeries();
+
+    enum Resolution { Recent,Hour,Day,ResolutionCount };
+
+    void add(double value);
+    void clear();
+    bool isEmpty() const;
+    double last() const;
+    QList<double> values(Resolution resolution = Recent) const; // Oldest first
+    int samplesPerPoint(Resolution resolution) const; // Raw samples behind each point at this resolution
+
+private:
+    class Ring {
+    public:
+        QList<double> data;
+        int head = 0;
+        int count = 0;
+        int capacity = 0;
+        int factor = 1; // Points from the previous ring per point here
+        double pendingSum = 0;
+        int pendingCount = 0;
+
+        void add(double value);
+    };
+
+    Ring rings[ResolutionCount];
+    double lastValue;
+};
+
+#endif // TELEMETRYSERIES_H
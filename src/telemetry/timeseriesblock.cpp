@@ -0,0 +1,260 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "timeseriesblock.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+namespace {
+
+class BitReader {
+public:
+    BitReader(const QByteArray &bytes) : bytes(bytes),position(0) {}
+
+    bool atEnd(int count) const {
+        return this->position+count>this->bytes.size()*8;
+    }
+
+    quint64 read(int count) {
+        quint64 value = 0;
+        for(int x=0;x<count;x++) {
+            uchar byte = this->bytes.at(this->position>>3);
+            value = (value<<1) | ((byte>>(7-(this->position&7)))&1);
+            this->position++;
+        }
+        return value;
+    }
+
+private:
+    const QByteArray &bytes;
+    qint64 position;
+};
+
+quint64 doubleBits(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits,&value,sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(quint64 bits)
+{
+    double value;
+    std::memcpy(&value,&bits,sizeof(value));
+    return value;
+}
+
+qint64 signExtend(quint64 value, int bits)
+{
+    return (qint64)(value<<(64-bits))>>(64-bits);
+}
+
+bool decodeValues(int count, const QByteArray &column, QList<double> &values)
+{
+    BitReader in(column);
+    if (in.atEnd(64)) {
+        return false;
+    }
+    quint64 previous = in.read(64);
+    values.append(bitsDouble(previous));
+    int leading = 0;
+    int meaningful = 0;
+    for(int x=1;x<count;x++) {
+        if (in.atEnd(1)) {
+            return false;
+        }
+        if (in.read(1)) {
+            if (in.atEnd(1)) {
+                return false;
+            }
+            if (in.read(1)) {
+                if (in.atEnd(11)) {
+                    return false;
+                }
+                leading = in.read(5);
+                meaningful = in.read(6);
+                if (meaningful==0) {
+                    meaningful = 64;
+                }
+            }
+            if (meaningful==0 || in.atEnd(meaningful)) {
+                return false;
+            }
+            previous ^= in.read(meaningful)<<(64-leading-meaningful);
+        }
+        values.append(bitsDouble(previous));
+    }
+    return true;
+}
+
+}
+
+TimeSeriesBlock::TimeSeriesBlock() : points(0),first(0),previousTime(0),previousDelta(0)
+{
+}
+
+void TimeSeriesBlock::BitWriter::write(quint64 value, int count)
+{
+    for(int x=count-1;x>=0;x--) {
+        if ((this->bits&7)==0) {
+            this->bytes.append('\0');
+        }
+        if ((value>>x)&1) {
+            this->bytes[this->bytes.size()-1] = this->bytes.at(this->bytes.size()-1) | (1<<(7-(this->bits&7)));
+        }
+        this->bits++;
+    }
+}
+
+void TimeSeriesBlock::ValueColumn::append(double value, bool first)
+{
+    quint64 bits = doubleBits(value);
+    if (first) {
+        this->out.write(bits,64);
+        this->previous = bits;
+        return;
+    }
+    quint64 xored = bits ^ this->previous;
+    this->previous = bits;
+    if (xored==0) {
+        this->out.write(0,1);
+        return;
+    }
+    int leadingZeros = qMin((int)qCountLeadingZeroBits(xored),31);
+    int trailingZeros = (int)qCountTrailingZeroBits(xored);
+    this->out.write(1,1);
+    if (this->leading>=0 && leadingZeros>=this->leading && trailingZeros>=this->trailing) {
+        // Fits in the previous window, only the meaningful bits are needed.
+        int meaningful = 64-this->leading-this->trailing;
+        this->out.write(0,1);
+        this->out.write(xored>>this->trailing,meaningful);
+    } else {
+        int meaningful = 64-leadingZeros-trailingZeros;
+        this->out.write(1,1);
+        this->out.write(leadingZeros,5);
+        this->out.write(meaningful&63,6); // 64 is written as 0
+        this->out.write(xored>>trailingZeros,meaningful);
+        this->leading = leadingZeros;
+        this->trailing = trailingZeros;
+    }
+}
+
+void TimeSeriesBlock::append(const TimeSeriesPoint &point)
+{
+    if (this->points==0) {
+        this->first = point.time;
+        this->times.write(point.time,64);
+    } else {
+        qint64 delta = point.time-this->previousTime;
+        qint64 deltaOfDelta = delta-this->previousDelta;
+        if (deltaOfDelta==0) {
+            this->times.write(0,1);
+        } else if (deltaOfDelta>=-63 && deltaOfDelta<=63) {
+            this->times.write(0b10,2);
+            this->times.write(deltaOfDelta,7);
+        } else if (deltaOfDelta>=-255 && deltaOfDelta<=255) {
+            this->times.write(0b110,3);
+            this->times.write(deltaOfDelta,9);
+        } else if (deltaOfDelta>=-2047 && deltaOfDelta<=2047) {
+            this->times.write(0b1110,4);
+            this->times.write(deltaOfDelta,12);
+        } else {
+            this->times.write(0b1111,4);
+            this->times.write(deltaOfDelta,64);
+        }
+        this->previousDelta = delta;
+    }
+    this->previousTime = point.time;
+    this->values.append(point.value,this->points==0);
+    this->peaks.append(point.peak,this->points==0);
+    this->points++;
+}
+
+bool TimeSeriesBlock::isEmpty() const
+{
+    return this->points==0;
+}
+
+int TimeSeriesBlock::count() const
+{
+    return this->points;
+}
+
+qint64 TimeSeriesBlock::firstTime() const
+{
+    return this->first;
+}
+
+qint64 TimeSeriesBlock::lastTime() const
+{
+    return this->previousTime;
+}
+
+QByteArray TimeSeriesBlock::timeColumn() const
+{
+    return this->times.bytes;
+}
+
+QByteArray TimeSeriesBlock::valueColumn() const
+{
+    return this->values.out.bytes;
+}
+
+QByteArray TimeSeriesBlock::peakColumn() const
+{
+    return this->peaks.out.bytes;
+}
+
+int TimeSeriesBlock::encodedSize() const
+{
+    return this->times.bytes.size()+this->values.out.bytes.size()+this->peaks.out.bytes.size();
+}
+
+bool TimeSeriesBlock::decode(int count, const QByteArray &times, const QByteArray &values, const QByteArray &peaks, QList<TimeSeriesPoint> &points)
+{
+    if (count<=0) {
+        return true;
+    }
+    QList<qint64> decodedTimes;
+    BitReader in(times);
+    if (in.atEnd(64)) {
+        return false;
+    }
+    qint64 time = in.read(64);
+    qint64 delta = 0;
+    decodedTimes.append(time);
+    for(int x=1;x<count;x++) {
+        int prefix = 0;
+        while (prefix<4 && !in.atEnd(1) && in.read(1)) {
+            prefix++;
+        }
+        static const int widths[] = { 0,7,9,12,64 };
+        if (in.atEnd(widths[prefix])) {
+            return false;
+        }
+        if (prefix>0) {
+            delta += signExtend(in.read(widths[prefix]),widths[prefix]);
+        }
+        time += delta;
+        decodedTimes.append(time);
+    }
+
+    QList<double> decodedValues;
+    QList<double> decodedPeaks;
+    if (!decodeValues(count,values,decodedValues) || !decodeValues(count,peaks,decodedPeaks)) {
+        return false;
+    }
+    for(int x=0;x<count;x++) {
+        points.append({decodedTimes.at(x),decodedValues.at(x),decodedPeaks.at(x)});
+    }
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef TIMESERIESBLOCK_H
+#define TIMESERIESBLOCK_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QByteArray>
+#include <QList>
+
+class TimeSeriesPoint
+{
+public:
+    qint64 time; // Seconds since the epoch
+    double value;
+    double peak; // Largest value the point covers, the same as value for raw samples
+};
+
+// Packs up to a few hundred points into three columns. Times are stored as the change
+// in the gap between samples and values as the XOR with the one before (the Gorilla
+// encoding), regular samples of slowly changing values take a couple of bits each.
+class TimeSeriesBlock
+{
+public:
+    TimeSeriesBlock();
+
+    void append(const TimeSeriesPoint &point);
+    bool isEmpty() const;
+    int count() const;
+    qint64 firstTime() const;
+    qint64 lastTime() const;
+    QByteArray timeColumn() const;
+    QByteArray valueColumn() const;
+    QByteArray peakColumn() const;
+    int encodedSize() const; // Bytes used by the columns
+
+    static bool decode(int count, const QByteArray &times, const QByteArray &values, const QByteArray &peaks, QList<TimeSeriesPoint> &points); // Appends to points
+
+private:
+    class BitWriter {
+    public:
+        QByteArray bytes;
+        int bits = 0;
+
+        void write(quint64 value, int count);
+    };
+
+    class ValueColumn {
+    public:
+        BitWriter out;
+        quint64 previous = 0;
+        int leading = -1; // Window of the previous XOR, -1 until there is one
+        int trailing = 0;
+
+        void append(double value, bool first);
+    };
+
+    int points;
+    qint64 first;
+    qint64 previousTime;
+    qint64 previousDelta;
+    BitWriter times;
+    ValueColumn values;
+    ValueColumn peaks;
+};
+
+#endif // TIMESERIESBLOCK_H
@@ -0,0 +1,387 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "timeseriesstore.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <limits>
+
+#define TIMESERIES_SUFFIX ".mcts"
+#define TIMESERIES_BLOCK_MAGIC 0x4d435453
+#define TIMESERIES_HEADER_BYTES 36
+#define TIMESERIES_BLOCK_POINTS 360
+#define TIMESERIES_OVERSAMPLE 4 // Read at most this many stored points per point returned before moving to a coarser tier
+#define TIMESERIES_PRUNE_INTERVAL_MS (6*60*60*1000)
+#define TIMESERIES_JOURNAL "open.mcjournal"
+#define TIMESERIES_JOURNAL_MAGIC 0x4d434a4e
+#define TIMESERIES_JOURNAL_INTERVAL_MS (60*1000)
+
+namespace {
+
+const char *tierSuffix(TimeSeriesStore::Tier tier)
+{
+    switch (tier) {
+    case TimeSeriesStore::Raw : return ".raw";
+    case TimeSeriesStore::FiveMinutes : return ".5m";
+    default : return ".1h";
+    }
+}
+
+}
+
+TimeSeriesStore::TimeSeriesStore(QString folder, QObject *parent) : QObject(parent),folder(folder),journalDirty(false)
+{
+    if (!QDir().mkpath(folder)) {
+        qDebug()<<"Can't create the history folder"<<folder;
+    }
+    prune();
+    this->pruneTimer.setInterval(TIMESERIES_PRUNE_INTERVAL_MS);
+    connect(&this->pruneTimer,&QTimer::timeout,this,&TimeSeriesStore::prune);
+    this->pruneTimer.start();
+    readJournal();
+    this->journalTimer.setInterval(TIMESERIES_JOURNAL_INTERVAL_MS);
+    connect(&this->journalTimer,&QTimer::timeout,this,&TimeSeriesStore::flush);
+    this->journalTimer.start();
+}
+
+TimeSeriesStore::~TimeSeriesStore()
+{
+    flush();
+}
+
+int TimeSeriesStore::tierSeconds(Tier tier)
+{
+    switch (tier) {
+    case Raw : return 10;
+    case FiveMinutes : return 5*60;
+    default : return 60*60;
+    }
+}
+
+qint64 TimeSeriesStore::tierRetentionSeconds(Tier tier)
+{
+    switch (tier) {
+    case Raw : return 14*24*60*60;
+    case FiveMinutes : return 400*24*60*60;
+    default : return 0;
+    }
+}
+
+void TimeSeriesStore::record(QString series, double value, qint64 time)
+{
+    if (time<0) {
+        time = QDateTime::currentSecsSinceEpoch();
+    }
+    addPoint(series,this->series[series],Raw,{time,value,value},1);
+    this->journalDirty = true;
+}
+
+void TimeSeriesStore::addPoint(const QString &name, Series &data, Tier tier, const TimeSeriesPoint &point, qint64 weight)
+{
+    TierData &tierData = data.tiers[tier];
+    tierData.head.append(point);
+    if (tierData.head.count()>=TIMESERIES_BLOCK_POINTS) {
+        sealBlock(name,tier,tierData);
+    }
+    if (tier+1>=TierCount) {
+        return;
+    }
+
+    // Average into the next tier, once a point lands in a new bucket the old one is complete.
+    Tier next = (Tier)(tier+1);
+    Bucket &bucket = data.tiers[next].bucket;
+    qint64 start = point.time-point.time%tierSeconds(next);
+    if (bucket.weight>0 && bucket.start!=start) {
+        TimeSeriesPoint summary = {bucket.start,bucket.sum/bucket.weight,bucket.peak};
+        qint64 summaryWeight = bucket.weight;
+        bucket = Bucket();
+        addPoint(name,data,next,summary,summaryWeight);
+    }
+    if (bucket.weight==0) {
+        bucket.start = start;
+        bucket.peak = point.peak;
+    }
+    bucket.sum += point.value*weight;
+    bucket.weight += weight;
+    bucket.peak = qMax(bucket.peak,point.peak);
+}
+
+void TimeSeriesStore::sealBlock(const QString &name, Tier tier, TierData &data)
+{
+    if (data.head.isEmpty()) {
+        return;
+    }
+    QFile file(fileName(name,tier));
+    if (!file.open(QIODevice::WriteOnly|QIODevice::Append)) {
+        qDebug()<<"Can't write history to"<<file.fileName()<<file.errorString();
+        data.head = TimeSeriesBlock();
+        return;
+    }
+    BlockRef block = {data.head.firstTime(),data.head.lastTime(),file.size()};
+    QDataStream out(&file);
+    out << (quint32)TIMESERIES_BLOCK_MAGIC << block.first << block.last << (quint32)data.head.count();
+    out << (quint32)data.head.timeColumn().size() << (quint32)data.head.valueColumn().size() << (quint32)data.head.peakColumn().size();
+    out.writeRawData(data.head.timeColumn().constData(),data.head.timeColumn().size());
+    out.writeRawData(data.head.valueColumn().constData(),data.head.valueColumn().size());
+    out.writeRawData(data.head.peakColumn().constData(),data.head.peakColumn().size());
+    if (data.blocksLoaded) {
+        data.blocks.append(block);
+    }
+    data.head = TimeSeriesBlock();
+}
+
+bool TimeSeriesStore::readBlockHeader(QIODevice *file, BlockRef &block, quint32 &count, quint32 columnBytes[3])
+{
+    block.offset = file->pos();
+    QDataStream in(file);
+    quint32 magic;
+    in >> magic >> block.first >> block.last >> count >> columnBytes[0] >> columnBytes[1] >> columnBytes[2];
+    return in.status()==QDataStream::Ok && magic==TIMESERIES_BLOCK_MAGIC;
+}
+
+void TimeSeriesStore::loadBlocks(const QString &name, Tier tier, TierData &data)
+{
+    if (data.blocksLoaded) {
+        return;
+    }
+    data.blocks.clear();
+    data.blocksLoaded = true;
+    QFile file(fileName(name,tier));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    BlockRef block;
+    quint32 count;
+    quint32 columnBytes[3];
+    while (!file.atEnd() && readBlockHeader(&file,block,count,columnBytes)) {
+        qint64 next = block.offset+TIMESERIES_HEADER_BYTES+columnBytes[0]+columnBytes[1]+columnBytes[2];
+        if (next>file.size()) {
+            qDebug()<<"History file"<<file.fileName()<<"ends part way through a block, ignoring it.";
+            break;
+        }
+        data.blocks.append(block);
+        file.seek(next);
+    }
+}
+
+QList<TimeSeriesPoint> TimeSeriesStore::query(QString series, qint64 from, qint64 to, int maxPoints)
+{
+    QList<TimeSeriesPoint> points;
+    if (to<from || maxPoints<1) {
+        return points;
+    }
+
+    // The finest tier that still covers 'from' without reading far more points than we return.
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    Tier tier = Raw;
+    while (tier+1<TierCount &&
+           ((tierRetentionSeconds(tier)>0 && from<now-tierRetentionSeconds(tier)) || (to-from)/tierSeconds(tier)>(qint64)maxPoints*TIMESERIES_OVERSAMPLE)) {
+        tier = (Tier)(tier+1);
+    }
+
+    TierData &data = this->series[series].tiers[tier];
+    loadBlocks(series,tier,data);
+    QList<TimeSeriesPoint> decoded;
+    if (!data.blocks.isEmpty()) {
+        QFile file(fileName(series,tier));
+        if (file.open(QIODevice::ReadOnly)) {
+            for(const BlockRef &ref : data.blocks) {
+                if (ref.last<from || ref.first>to) {
+                    continue;
+                }
+                BlockRef block;
+                quint32 count;
+                quint32 columnBytes[3];
+                if (!file.seek(ref.offset) || !readBlockHeader(&file,block,count,columnBytes)) {
+                    continue;
+                }
+                QByteArray times = file.read(columnBytes[0]);
+                QByteArray values = file.read(columnBytes[1]);
+                QByteArray peaks = file.read(columnBytes[2]);
+                if (!TimeSeriesBlock::decode(count,times,values,peaks,decoded)) {
+                    qDebug()<<"Skipping a damaged block in"<<file.fileName();
+                }
+            }
+        }
+    }
+    TimeSeriesBlock::decode(data.head.count(),data.head.timeColumn(),data.head.valueColumn(),data.head.peakColumn(),decoded);
+    if (data.bucket.weight>0) {
+        decoded.append({data.bucket.start,data.bucket.sum/data.bucket.weight,data.bucket.peak});
+    }
+
+    // Average down to maxPoints, keeping the largest peak in each slot.
+    qint64 slotSeconds = qMax((qint64)1,(to-from+1+maxPoints-1)/maxPoints);
+    qint64 slot = -1;
+    int merged = 0;
+    for(int x=0;x<decoded.size();x++) {
+        const TimeSeriesPoint &point = decoded.at(x);
+        if (point.time<from || point.time>to) {
+            continue;
+        }
+        qint64 pointSlot = (point.time-from)/slotSeconds;
+        if (pointSlot==slot && !points.isEmpty()) {
+            TimeSeriesPoint &last = points.last();
+            last.value = (last.value*merged+point.value)/(merged+1);
+            last.peak = qMax(last.peak,point.peak);
+            merged++;
+        } else {
+            points.append(point);
+            slot = pointSlot;
+            merged = 1;
+        }
+    }
+    return points;
+}
+
+void TimeSeriesStore::flush()
+{
+    // Open buckets aren't finished points, they're journalled as they are and carried on after a restart.
+    if (!this->journalDirty) {
+        return;
+    }
+    QSaveFile file(QDir(this->folder).filePath(TIMESERIES_JOURNAL));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug()<<"Can't write the history journal"<<file.fileName()<<file.errorString();
+        return;
+    }
+    QDataStream out(&file);
+    out << (quint32)TIMESERIES_JOURNAL_MAGIC << (qint32)this->series.size();
+    for(auto i=this->series.constBegin();i!=this->series.constEnd();i++) {
+        out << i.key();
+        for(int tier=Raw;tier<TierCount;tier++) {
+            const TierData &data = i.value().tiers[tier];
+            out << (qint32)data.head.count() << data.head.timeColumn() << data.head.valueColumn() << data.head.peakColumn();
+            out << data.bucket.start << data.bucket.sum << data.bucket.weight << data.bucket.peak;
+        }
+    }
+    if (!file.commit()) {
+        qDebug()<<"Can't write the history journal"<<file.fileName()<<file.errorString();
+        return;
+    }
+    this->journalDirty = false;
+}
+
+void TimeSeriesStore::readJournal()
+{
+    QFile file(QDir(this->folder).filePath(TIMESERIES_JOURNAL));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    quint32 magic;
+    qint32 count;
+    in >> magic >> count;
+    if (in.status()!=QDataStream::Ok || magic!=TIMESERIES_JOURNAL_MAGIC) {
+        qDebug()<<"Ignoring a damaged history journal"<<file.fileName();
+        return;
+    }
+    for(int x=0;x<count;x++) {
+        QString name;
+        in >> name;
+        for(int tier=Raw;tier<TierCount;tier++) {
+            qint32 points;
+            QByteArray times,values,peaks;
+            Bucket bucket;
+            in >> points >> times >> values >> peaks >> bucket.start >> bucket.sum >> bucket.weight >> bucket.peak;
+            if (in.status()!=QDataStream::Ok) {
+                qDebug()<<"History journal"<<file.fileName()<<"is cut short, ignoring the rest of it.";
+                return;
+            }
+
+            // Anything sealed after the journal was written is already in the file.
+            TierData &data = this->series[name].tiers[tier];
+            loadBlocks(name,(Tier)tier,data);
+            qint64 sealed = data.blocks.isEmpty() ? std::numeric_limits<qint64>::min() : data.blocks.last().last;
+            QList<TimeSeriesPoint> head;
+            if (TimeSeriesBlock::decode(points,times,values,peaks,head)) {
+                for(const TimeSeriesPoint &point : head) {
+                    if (point.time>sealed) {
+                        data.head.append(point);
+                    }
+                }
+            }
+            if (bucket.weight>0 && bucket.start>sealed) {
+                data.bucket = bucket;
+            }
+        }
+    }
+}
+
+void TimeSeriesStore::prune()
+{
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    QDir dir(this->folder);
+    for(int tier=Raw;tier<TierCount;tier++) {
+        qint64 retention = tierRetentionSeconds((Tier)tier);
+        if (retention==0) {
+            continue;
+        }
+        const QStringList files = dir.entryList({QString("*%1%2").arg(tierSuffix((Tier)tier),TIMESERIES_SUFFIX)},QDir::Files);
+        for(const QString &name : files) {
+            QFile file(dir.filePath(name));
+            if (!file.open(QIODevice::ReadOnly)) {
+                continue;
+            }
+            // Blocks are in time order, so everything before the first one worth keeping goes.
+            BlockRef block;
+            quint32 count;
+            quint32 columnBytes[3];
+            qint64 keepFrom = -1;
+            while (!file.atEnd()) {
+                if (!readBlockHeader(&file,block,count,columnBytes)) {
+                    keepFrom = block.offset; // Leave anything we can't read alone
+                    break;
+                }
+                if (block.last>=now-retention) {
+                    keepFrom = block.offset;
+                    break;
+                }
+                file.seek(block.offset+TIMESERIES_HEADER_BYTES+columnBytes[0]+columnBytes[1]+columnBytes[2]);
+            }
+            if (keepFrom==0 || file.size()==0) {
+                continue;
+            }
+            if (keepFrom<0) {
+                file.close();
+                if (!file.remove()) {
+                    qDebug()<<"Can't prune history file"<<file.fileName()<<file.errorString();
+                    continue;
+                }
+            } else {
+                // Closed before the save file replaces it.
+                file.seek(keepFrom);
+                QByteArray tail = file.readAll();
+                file.close();
+                QSaveFile kept(file.fileName());
+                if (!kept.open(QIODevice::WriteOnly) || kept.write(tail)<0 || !kept.commit()) {
+                    qDebug()<<"Can't prune history file"<<file.fileName()<<kept.errorString();
+                    continue;
+                }
+            }
+            qDebug()<<"Pruned old history from"<<name;
+        }
+    }
+    for(auto i=this->series.begin();i!=this->series.end();i++) {
+        for(int tier=Raw;tier<TierCount;tier++) {
+            i.value().tiers[tier].blocksLoaded = false;
+        }
+    }
+}
+
+QString TimeSeriesStore::fileName(const QString &name, Tier tier)
+{
+    return QDir(this->folder).filePath(name+tierSuffix(tier)+TIMESERIES_SUFFIX);
+}
@@ -0,0 +1,89 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include "timeseriesblock.h"
+
+// An append only store of named series. Each series is kept at three resolutions,
+// samples as recorded, five minute and hourly averages (with the peak of each), so old
+// data shrinks to a point an hour and long ranges chart from a few hundred points.
+// Blocks are appended to one file per series and resolution, and expire per resolution.
+// Points not yet in a block and the buckets still being averaged are journalled every
+// minute, so a restart carries on from them rather than losing or repeating them.
+class TimeSeriesStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TimeSeriesStore(QString folder, QObject *parent = nullptr);
+    ~TimeSeriesStore();
+
+    enum Tier { Raw,FiveMinutes,Hourly,TierCount };
+
+    static int tierSeconds(Tier tier); // Nominal spacing of points
+    static qint64 tierRetentionSeconds(Tier tier); // 0 keeps everything
+
+    void record(QString series, double value, qint64 time = -1); // Time in seconds since the epoch, -1 for now
+    QList<TimeSeriesPoint> query(QString series, qint64 from, qint64 to, int maxPoints); // Oldest first, at most maxPoints
+
+public slots:
+    void flush(); // Journals every partly filled block and bucket.
+    void prune();
+
+private:
+    class BlockRef {
+    public:
+        qint64 first;
+        qint64 last;
+        qint64 offset;
+    };
+
+    class Bucket {
+    public:
+        qint64 start = -1;
+        double sum = 0;
+        qint64 weight = 0; // Samples averaged so far
+        double peak = 0;
+    };
+
+    class TierData {
+    public:
+        TimeSeriesBlock head; // Not yet written
+        QList<BlockRef> blocks;
+        bool blocksLoaded = false;
+        Bucket bucket; // Being averaged into the next point, unused for Raw
+    };
+
+    class Series {
+    public:
+        TierData tiers[TierCount];
+    };
+
+    QString folder;
+    QHash<QString,Series> series;
+    QTimer pruneTimer;
+    QTimer journalTimer;
+    bool journalDirty;
+
+    QString fileName(const QString &name, Tier tier);
+    void addPoint(const QString &name, Series &data, Tier tier, const TimeSeriesPoint &point, qint64 weight);
+    void sealBlock(const QString &name, Tier tier, TierData &data);
+    void loadBlocks(const QString &name, Tier tier, TierData &data);
+    void readJournal();
+    static bool readBlockHeader(QIODevice *file, BlockRef &block, quint32 &count, quint32 columnBytes[3]);
+};
+
+#endif // TIMESERIESSTORE_H
@@ -0,0 +1,63 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "consolelinedelegate.h"
+#include <QPainter>
+#include <QApplication>
+#include <QElapsedTimer>
+
+ConsoleLineDelegate::ConsoleLineDelegate(QObject *parent) : QStyledItemDelegate(parent),paintNs(0)
+{
+}
+
+void ConsoleLineDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QElapsedTimer timer;
+    timer.start();
+    painter->save();
+
+    QRect rect = option.rect;
+    bool selected = option.state & QStyle::State_Selected;
+    QVariant background = index.data(Qt::BackgroundRole);
+    QVariant foreground = index.data(Qt::ForegroundRole);
+
+    if (selected) {
+        painter->fillRect(rect,option.palette.highlight());
+        painter->setPen(option.palette.highlightedText().color());
+    } else {
+        if (background.isValid()) {
+            painter->fillRect(rect,background.value<QColor>());
+        }
+        painter->setPen(foreground.isValid() ? foreground.value<QColor>() : option.palette.text().color());
+    }
+
+    painter->setFont(option.font);
+    rect.adjust(2,0,-2,0);
+    QString text = index.data(Qt::DisplayRole).toString();
+    painter->drawText(rect,Qt::AlignLeft|Qt::AlignVCenter|Qt::TextSingleLine,option.fontMetrics.elidedText(text,Qt::ElideRight,rect.width()));
+
+    painter->restore();
+    this->paintNs += timer.nsecsElapsed();
+}
+
+QSize ConsoleLineDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &) const
+{
+    // Every row is the same height, the view uses uniform item sizes so this is asked once.
+    return QSize(option.rect.width(),option.fontMetrics.height()+2);
+}
+
+qint64 ConsoleLineDelegate::takePaintNs()
+{
+    qint64 ret = this->paintNs;
+    this->paintNs = 0;
+    return ret;
+}
@@ -0,0 +1,33 @@
+#ifndef CONSOLELINEDELEGATE_H
+#define CONSOLELINEDELEGATE_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QStyledItemDelegate>
+
+// Draws a console line as a single row of plain text, no rich text layout.
+class ConsoleLineDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit ConsoleLineDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    qint64 takePaintNs(); // Time spent painting rows since the last call.
+private:
+    mutable qint64 paintNs;
+};
+
+#endif // CONSOLELINEDELEGATE_H
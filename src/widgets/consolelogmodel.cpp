@@ -0,0 +1,173 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "consolelogmodel.h"
+#include <QDateTime>
+#include <QColor>
+
+ConsoleLogModel::ConsoleLogModel(QObject *parent)
+    : QAbstractListModel(parent),store(500000)
+{
+}
+
+int ConsoleLogModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return this->store.count();
+}
+
+QVariant ConsoleLogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row()>=this->store.count())
+        return QVariant();
+
+    int row = index.row();
+    BedrockServer::OutputType type = this->store.type(row);
+    switch (role) {
+    case Qt::DisplayRole :
+        if (this->store.repeats(row)>1) {
+            return tr("%1  (x%2, last at %3)").arg(this->store.text(row)).arg(this->store.repeats(row))
+                    .arg(QDateTime::fromMSecsSinceEpoch(this->store.lastTime(row)).toString("hh:mm:ss"));
+        }
+        return this->store.text(row);
+    case Qt::ToolTipRole :
+    case MessageRole :
+        return this->store.text(row);
+    case Qt::ForegroundRole :
+        switch (type) {
+        case BedrockServer::InfoOutput : return QColor(0x006de9);
+        case BedrockServer::ErrorOutput : return QColor(0xe90b00);
+        case BedrockServer::WarningOutput : return QColor(Qt::yellow);
+        case BedrockServer::ServerStatus : return QColor(0x31ac0f);
+        default : return QVariant();
+        }
+    case Qt::BackgroundRole :
+        return (type==BedrockServer::WarningOutput) ? QVariant(QColor(0xe90b00)) : QVariant();
+    case OutputTypeRole :
+        return (int)type;
+    case TimeRole :
+        return QDateTime::fromMSecsSinceEpoch(this->store.time(row));
+    case RepeatRole :
+        return this->store.repeats(row);
+    }
+    return QVariant();
+}
+
+void ConsoleLogModel::appendLine(BedrockServer::OutputType type, QString text)
+{
+    appendLines(QList<QPair<BedrockServer::OutputType,QString>>() << qMakePair(type,text));
+}
+
+void ConsoleLogModel::appendLines(const QList<QPair<BedrockServer::OutputType,QString>> &newLines)
+{
+    QList<LogRecord> records;
+    records.reserve(newLines.size());
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for(const auto &newLine : newLines) {
+        LogRecord record;
+        record.time = now;
+        record.type = newLine.first;
+        record.text = newLine.second;
+        records.append(record);
+    }
+    appendRecords(records);
+}
+
+void ConsoleLogModel::appendRecords(const QList<LogRecord> &records)
+{
+    if (records.isEmpty()) {
+        return;
+    }
+    // If more lines arrive than fit, only the newest ones are kept.
+    QList<LogRecord> kept = (records.size() > this->store.capacity()) ? records.mid(records.size()-this->store.capacity()) : records;
+    int lastRow = this->store.count()-1;
+    int adding = this->store.countNewEntries(kept);
+    int drop = this->store.count() + adding - this->store.capacity();
+
+    if (drop>=this->store.count() && drop>0) {
+        // Everything currently shown goes, simpler to start again.
+        beginResetModel();
+        this->store.removeOldest(this->store.count());
+        for(const LogRecord &record : kept) {
+            this->store.append(record);
+        }
+        endResetModel();
+        return;
+    }
+    if (drop>0) {
+        beginRemoveRows(QModelIndex(),0,drop-1);
+        this->store.removeOldest(drop);
+        endRemoveRows();
+        lastRow -= drop;
+    }
+
+    bool lastChanged = false;
+    if (adding>0) {
+        beginInsertRows(QModelIndex(),this->store.count(),this->store.count()+adding-1);
+    }
+    for(const LogRecord &record : kept) {
+        if (!this->store.append(record) && this->store.count()-1==lastRow) {
+            lastChanged = true;
+        }
+    }
+    if (adding>0) {
+        endInsertRows();
+    }
+    if (lastChanged) {
+        emit dataChanged(index(lastRow),index(lastRow));
+    }
+}
+
+void ConsoleLogModel::setCapacity(int lines)
+{
+    if (lines<1 || lines==this->store.capacity()) {
+        return;
+    }
+    beginResetModel();
+    this->store.setCapacity(lines);
+    endResetModel();
+}
+
+int ConsoleLogModel::rowForTime(QDateTime time)
+{
+    // Lines are appended in time order, so the ring can be searched by row.
+    qint64 target = time.toMSecsSinceEpoch();
+    int low = 0;
+    int high = this->store.count();
+    while (low<high) {
+        int mid = (low+high)/2;
+        if (this->store.lastTime(mid)<target) {
+            low = mid+1;
+        } else {
+            high = mid;
+        }
+    }
+    return (low<this->store.count()) ? low : -1;
+}
+
+int ConsoleLogModel::capacity()
+{
+    return this->store.capacity();
+}
+
+void ConsoleLogModel::clear()
+{
+    beginResetModel();
+    this->store.clear();
+    endResetModel();
+}
+
+const LogStore &ConsoleLogModel::getStore()
+{
+    return this->store;
+}
@@ -0,0 +1,49 @@
+#ifndef CONSOLELOGMODEL_H
+#define CONSOLELOGMODEL_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QAbstractListModel>
+#include <QList>
+#include <QPair>
+#include <QDateTime>
+#include <server/bedrockserver.h>
+#include <logging/logstore.h>
+
+// Console lines held in a fixed size LogStore ring, oldest lines fall off the top once it's full.
+// Identical consecutive lines share a row, shown with a repeat count.
+class ConsoleLogModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit ConsoleLogModel(QObject *parent = nullptr);
+
+    enum Roles { OutputTypeRole = Qt::UserRole+1,TimeRole,MessageRole,RepeatRole };
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void appendLine(BedrockServer::OutputType type, QString text);
+    void appendLines(const QList<QPair<BedrockServer::OutputType,QString>> &newLines); // One ranged insert for the lot.
+    void appendRecords(const QList<LogRecord> &records); // As above, keeping each record's time.
+    int rowForTime(QDateTime time); // First row at or after time, -1 if it's after everything.
+    void setCapacity(int lines);
+    int capacity();
+    void clear();
+    const LogStore &getStore();
+
+private:
+    LogStore store;
+};
+
+#endif // CONSOLELOGMODEL_H
@@ -0,0 +1,157 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "historychartwidget.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QMouseEvent>
+#include <QToolTip>
+#include <QDateTime>
+#include <QtMath>
+#include <algorithm>
+
+#define HISTORY_CHART_TICKS 6
+#define HISTORY_CHART_GAP_FACTOR 5 // A gap this many times the usual spacing is drawn as a break in the line
+
+HistoryChartWidget::HistoryChartWidget(QWidget *parent) : QWidget(parent),from(0),to(0),top(1)
+{
+    setMouseTracking(true);
+}
+
+void HistoryChartWidget::setPoints(QList<TimeSeriesPoint> points, qint64 from, qint64 to, QString unit)
+{
+    this->points = points;
+    this->from = from;
+    this->to = qMax(to,from+1);
+    this->unit = unit;
+
+    // Round the top of the scale up to 1, 2 or 5 times a power of ten.
+    double largest = 0;
+    for(int x=0;x<points.size();x++) {
+        largest = qMax(largest,points.at(x).peak);
+    }
+    this->top = 1;
+    if (largest>0) {
+        double magnitude = qPow(10,qFloor(std::log10(largest)));
+        this->top = largest<=magnitude ? magnitude : largest<=2*magnitude ? 2*magnitude : largest<=5*magnitude ? 5*magnitude : 10*magnitude;
+    }
+    update();
+}
+
+QSize HistoryChartWidget::sizeHint() const
+{
+    return QSize(600,300);
+}
+
+QRectF HistoryChartWidget::chartArea() const
+{
+    int labelWidth = fontMetrics().horizontalAdvance(QString("%1 %2").arg(this->top*10).arg(this->unit));
+    return QRectF(rect()).adjusted(labelWidth+8,fontMetrics().height()/2+2,-12,-fontMetrics().height()-6);
+}
+
+QPointF HistoryChartWidget::position(qint64 time, double value) const
+{
+    QRectF chart = chartArea();
+    return QPointF(chart.left()+chart.width()*(time-this->from)/(double)(this->to-this->from),
+                   chart.bottom()-chart.height()*value/this->top);
+}
+
+void HistoryChartWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QRectF chart = chartArea();
+    painter.fillRect(chart,palette().base());
+
+    // Grid and labels
+    QPen gridPen(palette().mid().color(),0,Qt::DotLine);
+    QString timeFormat = this->to-this->from<=2*24*60*60 ? "ddd HH:mm" : "d MMM";
+    for(int x=0;x<=HISTORY_CHART_TICKS;x++) {
+        double y = chart.bottom()-chart.height()*x/HISTORY_CHART_TICKS;
+        painter.setPen(gridPen);
+        painter.drawLine(QPointF(chart.left(),y),QPointF(chart.right(),y));
+        painter.setPen(palette().text().color());
+        painter.drawText(QRectF(0,y-fontMetrics().height()/2.0,chart.left()-4,fontMetrics().height()),Qt::AlignRight|Qt::AlignVCenter,
+                         QString("%1 %2").arg(this->top*x/HISTORY_CHART_TICKS).arg(this->unit));
+
+        double xPos = chart.left()+chart.width()*x/HISTORY_CHART_TICKS;
+        painter.setPen(gridPen);
+        painter.drawLine(QPointF(xPos,chart.top()),QPointF(xPos,chart.bottom()));
+        painter.setPen(palette().text().color());
+        QString label = QDateTime::fromSecsSinceEpoch(this->from+(this->to-this->from)*x/HISTORY_CHART_TICKS).toString(timeFormat);
+        int align = x==0 ? Qt::AlignLeft : x==HISTORY_CHART_TICKS ? Qt::AlignRight : Qt::AlignHCenter;
+        double width = fontMetrics().horizontalAdvance(label)+4;
+        double left = x==0 ? xPos : x==HISTORY_CHART_TICKS ? xPos-width : xPos-width/2;
+        painter.drawText(QRectF(left,chart.bottom()+4,width,fontMetrics().height()),align,label);
+    }
+
+    if (this->points.isEmpty()) {
+        painter.drawText(chart,Qt::AlignCenter,tr("Nothing recorded for this range yet."));
+        return;
+    }
+
+    // Lines break where nothing was recorded, usually while the server was down.
+    QList<qint64> gaps;
+    for(int x=1;x<this->points.size();x++) {
+        gaps.append(this->points.at(x).time-this->points.at(x-1).time);
+    }
+    qint64 usualGap = 0;
+    if (!gaps.isEmpty()) {
+        std::nth_element(gaps.begin(),gaps.begin()+gaps.size()/2,gaps.end());
+        usualGap = gaps.at(gaps.size()/2);
+    }
+    QPainterPath average;
+    QPainterPath peak;
+    for(int x=0;x<this->points.size();x++) {
+        const TimeSeriesPoint &point = this->points.at(x);
+        bool newLine = x==0 || point.time-this->points.at(x-1).time>usualGap*HISTORY_CHART_GAP_FACTOR;
+        if (newLine) {
+            average.moveTo(position(point.time,point.value));
+            peak.moveTo(position(point.time,point.peak));
+        } else {
+            average.lineTo(position(point.time,point.value));
+            peak.lineTo(position(point.time,point.peak));
+        }
+    }
+    painter.setClipRect(chart);
+    painter.setPen(QPen(QColor(0xe98a00),1));
+    painter.drawPath(peak);
+    painter.setPen(QPen(QColor(0x006de9),1.5));
+    painter.drawPath(average);
+    if (this->points.size()<60) {
+        painter.setBrush(QColor(0x006de9));
+        for(int x=0;x<this->points.size();x++) {
+            painter.drawEllipse(position(this->points.at(x).time,this->points.at(x).value),2.5,2.5);
+        }
+    }
+}
+
+void HistoryChartWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    QRectF chart = chartArea();
+    if (this->points.isEmpty() || !chart.contains(event->position())) {
+        QToolTip::hideText();
+        return;
+    }
+    qint64 time = this->from+(this->to-this->from)*(event->position().x()-chart.left())/chart.width();
+    auto nearest = std::lower_bound(this->points.begin(),this->points.end(),time,[](const TimeSeriesPoint &point, qint64 time) {
+        return point.time<time;
+    });
+    if (nearest==this->points.end() || (nearest!=this->points.begin() && time-(nearest-1)->time<nearest->time-time)) {
+        nearest--;
+    }
+    QString text = QString("%1\n%2 %3").arg(QDateTime::fromSecsSinceEpoch(nearest->time).toString("ddd d MMM HH:mm")).arg(nearest->value,0,'f',1).arg(this->unit);
+    if (nearest->peak>nearest->value) {
+        text += tr("\nPeak %1 %2").arg(nearest->peak,0,'f',1).arg(this->unit);
+    }
+    QToolTip::showText(event->globalPosition().toPoint(),text,this);
+}
@@ -0,0 +1,46 @@
+#ifndef HISTORYCHARTWIDGET_H
+#define HISTORYCHARTWIDGET_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QWidget>
+#include <QList>
+#include <telemetry/timeseriesblock.h>
+
+// Charts the average and peak of a stored series over a time range, hovering shows
+// the values at that point.
+class HistoryChartWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit HistoryChartWidget(QWidget *parent = nullptr);
+
+    void setPoints(QList<TimeSeriesPoint> points, qint64 from, qint64 to, QString unit);
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    QList<TimeSeriesPoint> points;
+    qint64 from;
+    qint64 to;
+    QString unit;
+    double top;
+
+    QRectF chartArea() const;
+    QPointF position(qint64 time, double value) const;
+};
+
+#endif // HISTORYCHARTWIDGET_H
@@ -0,0 +1,134 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "loghistorydialog.h"
+#include "ui_loghistorydialog.h"
+#include "consolelinedelegate.h"
+#include <QFileDialog>
+#include <QFontDatabase>
+
+#define HISTORY_MAX_LINES 200000
+
+LogHistoryDialog::LogHistoryDialog(LogArchive *archive, QDateTime from, QDateTime to, QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::LogHistoryDialog),
+    archive(archive),
+    readRequest(-1),
+    exportRequest(-1)
+{
+    ui->setupUi(this);
+    setWindowTitle(tr("Server log history"));
+
+    this->historyModel = new ConsoleLogModel(this);
+    this->historyModel->setCapacity(HISTORY_MAX_LINES);
+    this->ui->historyView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    this->ui->historyView->setItemDelegate(new ConsoleLineDelegate(this));
+    this->ui->historyView->setModel(this->historyModel);
+
+    connect(this->ui->showButton,&QPushButton::clicked,this,[=]() { this->showRange(); });
+    connect(this->ui->exportButton,&QPushButton::clicked,this,[=]() { this->exportRange(); });
+    connect(this->archive,&LogArchive::rangeRead,this,&LogHistoryDialog::rangeRead);
+    connect(this->archive,&LogArchive::rangeExported,this,&LogHistoryDialog::rangeExported);
+
+    setRange(from,to);
+}
+
+LogHistoryDialog::~LogHistoryDialog()
+{
+    delete ui;
+}
+
+void LogHistoryDialog::setRange(QDateTime from, QDateTime to)
+{
+    QDateTime oldest = this->archive->getOldestTime();
+    if (oldest.isValid()) {
+        this->ui->fromTime->setMinimumDateTime(oldest);
+    }
+    this->ui->fromTime->setDateTime(from);
+    this->ui->toTime->setDateTime(to);
+    this->pendingTime = QDateTime();
+    showRange();
+}
+
+void LogHistoryDialog::showTime(QDateTime time)
+{
+    if (this->readRequest>=0) {
+        this->pendingTime = time;
+        return;
+    }
+    int row = this->historyModel->rowForTime(time);
+    if (row>=0) {
+        QModelIndex index = this->historyModel->index(row);
+        this->ui->historyView->setCurrentIndex(index);
+        this->ui->historyView->scrollTo(index,QAbstractItemView::PositionAtCenter);
+    }
+}
+
+void LogHistoryDialog::showRange()
+{
+    this->readRequest = this->archive->readRange(this->ui->fromTime->dateTime(),this->ui->toTime->dateTime(),HISTORY_MAX_LINES);
+    this->ui->showButton->setEnabled(false);
+    this->ui->historyStatus->setText(tr("Reading the log..."));
+}
+
+void LogHistoryDialog::rangeRead(int request, QList<LogRecord> records)
+{
+    if (request!=this->readRequest) {
+        return;
+    }
+    this->readRequest = -1;
+    this->ui->showButton->setEnabled(true);
+    this->historyModel->clear();
+    this->historyModel->appendRecords(records);
+    this->ui->historyView->scrollToTop();
+
+    if (records.isEmpty()) {
+        this->ui->historyStatus->setText(tr("Nothing was logged in that time."));
+    } else {
+        this->ui->historyStatus->setText(tr("%Ln line(s) from %1 to %2%3","",records.size())
+                                         .arg(QDateTime::fromMSecsSinceEpoch(records.first().time).toString())
+                                         .arg(QDateTime::fromMSecsSinceEpoch(records.last().time).toString())
+                                         .arg(records.size()>=HISTORY_MAX_LINES ? tr(", export the range to see the rest.") : QString("."))
+                                         );
+    }
+
+    if (this->pendingTime.isValid()) {
+        showTime(this->pendingTime);
+        this->pendingTime = QDateTime();
+    }
+}
+
+void LogHistoryDialog::exportRange()
+{
+    QString fileName = QFileDialog::getSaveFileName(this,tr("Export server log"),QString("server_log_%1.txt").arg(this->ui->fromTime->dateTime().toString("yyyyMMdd_hhmmss")),tr("Text files (*.txt)"));
+    if (fileName=="") {
+        return;
+    }
+    this->exportFileName = fileName;
+    this->exportRequest = this->archive->exportRange(this->ui->fromTime->dateTime(),this->ui->toTime->dateTime(),fileName);
+    this->ui->exportButton->setEnabled(false);
+    this->ui->historyStatus->setText(tr("Exporting to %1...").arg(fileName));
+}
+
+void LogHistoryDialog::rangeExported(int request, qint64 lines)
+{
+    if (request!=this->exportRequest) {
+        return;
+    }
+    this->exportRequest = -1;
+    this->ui->exportButton->setEnabled(true);
+    if (lines<0) {
+        this->ui->historyStatus->setText(tr("Unable to write %1").arg(this->exportFileName));
+    } else {
+        this->ui->historyStatus->setText(tr("%Ln line(s) exported to %1","",lines).arg(this->exportFileName));
+    }
+}
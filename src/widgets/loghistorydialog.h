@@ -0,0 +1,51 @@
+#ifndef LOGHISTORYDIALOG_H
+#define LOGHISTORYDIALOG_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QDialog>
+#include <logging/logarchive.h>
+#include "consolelogmodel.h"
+
+namespace Ui {
+class LogHistoryDialog;
+}
+
+// Shows or exports a time range from the log archive, for anything older than the console holds.
+class LogHistoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LogHistoryDialog(LogArchive *archive, QDateTime from, QDateTime to, QWidget *parent = nullptr);
+    ~LogHistoryDialog();
+
+    void setRange(QDateTime from, QDateTime to); // Reads the new range in.
+    void showTime(QDateTime time); // Scrolls to and selects the first line at or after time, once the range has been read.
+
+private:
+    Ui::LogHistoryDialog *ui;
+    LogArchive *archive;
+    ConsoleLogModel *historyModel;
+    int readRequest; // -1 when nothing is being read
+    int exportRequest; // -1 when nothing is being exported
+    QString exportFileName;
+    QDateTime pendingTime;
+
+    void showRange();
+    void exportRange();
+    void rangeRead(int request, QList<LogRecord> records);
+    void rangeExported(int request, qint64 lines);
+};
+
+#endif // LOGHISTORYDIALOG_H
@@ -24,10 +24,7 @@ void OnlinePlayerWidget::setServer(BedrockServer *server)
 {
     this->server = server;
 
-    connect(server,&BedrockServer::playerConnected,this,[=](QString,QString) {
-       setup();
-    });
-    connect(server,&BedrockServer::playerDisconnected,this,[=](QString,QString) {
+    connect(server,&BedrockServer::onlinePlayersChanged,this,[=]() {
        setup();
     });
     connect(server,&BedrockServer::serverStateChanged,this,[=](BedrockServer::ServerState) {
@@ -100,7 +97,7 @@ void OnlinePlayerWidget::setup()
         this->usersOnline->setAutoFillBackground(true);
     }
 
-    this->usersOnline->repaint();
-    this->opsOnline->repaint();
-    this->repaint();
+    this->usersOnline->update();
+    this->opsOnline->update();
+    this->update();
 }
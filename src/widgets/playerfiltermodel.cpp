@@ -0,0 +1,200 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "playerfiltermodel.h"
+#include <server/bedrockservermodel.h>
+#include <QDateTime>
+#include <algorithm>
+
+PlayerFilterModel::PlayerFilterModel(QObject *parent) : QSortFilterProxyModel(parent),order(ListOrder),indexStale(true)
+{
+}
+
+void PlayerFilterModel::setSourceModel(QAbstractItemModel *model)
+{
+    // Connected ahead of the proxy's own handlers, so the matches already include new and
+    // renamed players by the time their rows are filtered.
+    auto stale = [=]() {
+        this->indexStale = true;
+    };
+    connect(model,&QAbstractItemModel::rowsInserted,this,[=](const QModelIndex &parent, int first, int last) {
+        this->indexStale = true;
+        updateMatches(parent,first,last);
+    });
+    connect(model,&QAbstractItemModel::dataChanged,this,[=](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        this->indexStale = true;
+        updateMatches(topLeft.parent(),topLeft.row(),bottomRight.row());
+    });
+    connect(model,&QAbstractItemModel::rowsRemoved,this,stale);
+    connect(model,&QAbstractItemModel::rowsMoved,this,stale);
+    connect(model,&QAbstractItemModel::modelReset,this,[=]() {
+        this->indexStale = true;
+        findMatches();
+    });
+    QSortFilterProxyModel::setSourceModel(model);
+}
+
+void PlayerFilterModel::setSearchText(QString text)
+{
+    text = text.trimmed().toLower();
+    if (text==this->search) {
+        return;
+    }
+    this->search = text;
+    if (!this->search.isEmpty()) {
+        fetchAll();
+    }
+    findMatches();
+    invalidateFilter();
+}
+
+void PlayerFilterModel::setSortOrder(SortOrder order)
+{
+    this->order = order;
+    if (order!=ListOrder) {
+        fetchAll(); // Sorting a page of a branch would put the wrong players first
+    }
+    // Column -1 is the source order, without sorting at all.
+    int column = (order==ListOrder) ? -1 : 0;
+    if (column==sortColumn()) {
+        invalidate();
+    } else {
+        sort(column,Qt::AscendingOrder);
+    }
+}
+
+PlayerFilterModel::SortOrder PlayerFilterModel::getSortOrder()
+{
+    return this->order;
+}
+
+void PlayerFilterModel::setPlayTimes(QHash<QString,qint64> seconds)
+{
+    this->playTimes = seconds;
+    if (this->order==ByPlayTime) {
+        invalidate();
+    }
+}
+
+bool PlayerFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (this->search.isEmpty() || !sourceParent.isValid()) {
+        return true;
+    }
+    QModelIndex index = sourceModel()->index(sourceRow,0,sourceParent);
+    return this->matches.contains(index.data(BedrockServerModel::XuidRole).toString());
+}
+
+bool PlayerFilterModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+    if (!left.parent().isValid() || this->order==ListOrder) {
+        return left.row()<right.row();
+    }
+    QString leftXuid = left.data(BedrockServerModel::XuidRole).toString();
+    QString rightXuid = right.data(BedrockServerModel::XuidRole).toString();
+    if (this->order==ByLastSeen) {
+        QDateTime leftSeen = left.data(BedrockServerModel::LastSeenRole).toDateTime();
+        QDateTime rightSeen = right.data(BedrockServerModel::LastSeenRole).toDateTime();
+        if (leftSeen!=rightSeen) {
+            return leftSeen>rightSeen; // Most recent first, never seen last
+        }
+    } else if (this->order==ByPlayTime) {
+        qint64 leftTime = this->playTimes.value(leftXuid);
+        qint64 rightTime = this->playTimes.value(rightXuid);
+        if (leftTime!=rightTime) {
+            return leftTime>rightTime;
+        }
+    } else if (this->order==ByPermission) {
+        // Operators, then members, then visitors.
+        const int rank[] = { 1,0,2 };
+        int leftPermission = left.data(BedrockServerModel::PermissionRole).toInt();
+        int rightPermission = right.data(BedrockServerModel::PermissionRole).toInt();
+        int leftRank = (leftPermission>=0 && leftPermission<3) ? rank[leftPermission] : 3;
+        int rightRank = (rightPermission>=0 && rightPermission<3) ? rank[rightPermission] : 3;
+        if (leftRank!=rightRank) {
+            return leftRank<rightRank;
+        }
+    }
+    int byName = QString::compare(left.data().toString(),right.data().toString(),Qt::CaseInsensitive);
+    return byName!=0 ? byName<0 : leftXuid<rightXuid;
+}
+
+void PlayerFilterModel::fetchAll()
+{
+    QAbstractItemModel *model = sourceModel();
+    for(int x=0;model && x<model->rowCount();x++) {
+        QModelIndex branch = model->index(x,0);
+        while (model->canFetchMore(branch)) {
+            model->fetchMore(branch);
+        }
+    }
+}
+
+void PlayerFilterModel::rebuildIndex()
+{
+    this->prefixIndex.clear();
+    QAbstractItemModel *model = sourceModel();
+    for(int x=0;model && x<model->rowCount();x++) {
+        QModelIndex branch = model->index(x,0);
+        int rows = model->rowCount(branch);
+        for(int row=0;row<rows;row++) {
+            QModelIndex index = model->index(row,0,branch);
+            QString xuid = index.data(BedrockServerModel::XuidRole).toString();
+            QString name = index.data().toString().toLower();
+            this->prefixIndex.append(qMakePair(xuid,xuid));
+            if (name!=xuid) {
+                this->prefixIndex.append(qMakePair(name,xuid));
+            }
+        }
+    }
+    std::sort(this->prefixIndex.begin(),this->prefixIndex.end());
+    this->indexStale = false;
+}
+
+void PlayerFilterModel::findMatches()
+{
+    this->matches.clear();
+    if (this->search.isEmpty()) {
+        return;
+    }
+    if (this->indexStale) {
+        rebuildIndex();
+    }
+    // Everything starting with the search sits in one run of the sorted index.
+    auto first = std::lower_bound(this->prefixIndex.constBegin(),this->prefixIndex.constEnd(),qMakePair(this->search,QString()));
+    for(auto i=first;i!=this->prefixIndex.constEnd() && i->first.startsWith(this->search);i++) {
+        this->matches.insert(i->second);
+    }
+}
+
+void PlayerFilterModel::updateMatches(const QModelIndex &parent, int first, int last)
+{
+    // Only the rows that arrived or changed are tested, the index catches up on the next search.
+    if (this->search.isEmpty() || !parent.isValid()) {
+        return;
+    }
+    for(int row=first;row<=last;row++) {
+        QModelIndex index = sourceModel()->index(row,0,parent);
+        QString xuid = index.data(BedrockServerModel::XuidRole).toString();
+        if (matchesSearch(index)) {
+            this->matches.insert(xuid);
+        } else {
+            this->matches.remove(xuid);
+        }
+    }
+}
+
+bool PlayerFilterModel::matchesSearch(const QModelIndex &sourceIndex) const
+{
+    return sourceIndex.data(BedrockServerModel::XuidRole).toString().startsWith(this->search) ||
+           sourceIndex.data().toString().toLower().startsWith(this->search);
+}
@@ -0,0 +1,56 @@
+#ifndef PLAYERFILTERMODEL_H
+#define PLAYERFILTERMODEL_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QSortFilterProxyModel>
+#include <QHash>
+#include <QSet>
+
+// Finds and orders players in the player tree. Searches match the start of a gamertag or
+// xuid, looked up in a sorted index of both rather than by testing every row's text. The
+// categories are always shown, in their usual order.
+class PlayerFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit PlayerFilterModel(QObject *parent = nullptr);
+
+    enum SortOrder { ListOrder,ByName,ByLastSeen,ByPlayTime,ByPermission };
+
+    void setSourceModel(QAbstractItemModel *model) override;
+    void setSearchText(QString text);
+    void setSortOrder(SortOrder order);
+    SortOrder getSortOrder();
+    void setPlayTimes(QHash<QString,qint64> seconds);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    QString search; // Lower case
+    SortOrder order;
+    QHash<QString,qint64> playTimes;
+    QList<QPair<QString,QString>> prefixIndex; // Lower case gamertag or xuid, and the xuid, sorted
+    bool indexStale;
+    QSet<QString> matches; // Xuids matching the search, kept up to date as players arrive or change
+
+    void fetchAll();
+    void rebuildIndex();
+    void findMatches();
+    void updateMatches(const QModelIndex &parent, int first, int last);
+    bool matchesSearch(const QModelIndex &sourceIndex) const;
+};
+
+#endif // PLAYERFILTERMODEL_H
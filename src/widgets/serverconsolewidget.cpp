@@ -1,12 +1,60 @@
 #include "serverconsolewidget.h"
 #include "ui_serverconsolewidget.h"
+#include "loghistorydialog.h"
+#include <QSettings>
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <QScrollBar>
+#include <QAction>
+#include <QKeyEvent>
+#include <QClipboard>
+#include <QGuiApplication>
+#include <algorithm>
+
+#define CONSOLE_FLUSH_INTERVAL_MS 16
+#define HISTORY_CONTEXT_SECS (10*60) // Either side of a search hit that's no longer in the console
 
 ServerConsoleWidget::ServerConsoleWidget(QWidget *parent) :
     QWidget(parent),
-    ui(new Ui::ServerConsoleWidget)
+    ui(new Ui::ServerConsoleWidget),logArchive(nullptr),logIndex(nullptr),historyDialog(nullptr),searchHit(-1),flushNs(0),linesShown(0)
 {
     ui->setupUi(this);
-    this->ui->serverOutput->setMaximumBlockCount(20000);
+    this->ui->historyButton->setVisible(false);
+    this->ui->searchEdit->setVisible(false);
+    this->ui->searchPrevious->setVisible(false);
+    this->ui->searchNext->setVisible(false);
+    this->ui->searchEdit->setPlaceholderText(tr("Search log history..."));
+    QSettings settings;
+    this->logModel = new ConsoleLogModel(this);
+    this->logModel->setCapacity(settings.value("console/historyLines",500000).toInt());
+    this->ui->serverOutput->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    this->lineDelegate = new ConsoleLineDelegate(this);
+    this->ui->serverOutput->setItemDelegate(this->lineDelegate);
+    this->ui->serverOutput->setModel(this->logModel);
+
+    // The view on its own would only copy the current line.
+    QAction *copyAction = new QAction(tr("Copy"),this->ui->serverOutput);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setShortcutContext(Qt::WidgetShortcut);
+    connect(copyAction,&QAction::triggered,this,&ServerConsoleWidget::copySelection);
+    this->ui->serverOutput->addAction(copyAction);
+    this->ui->serverOutput->setContextMenuPolicy(Qt::ActionsContextMenu);
+    this->ui->serverOutput->installEventFilter(this);
+
+    // Output is collected and handed to the view at most once a frame.
+    this->flushTimer = new QTimer(this);
+    this->flushTimer->setSingleShot(true);
+    this->flushTimer->setInterval(CONSOLE_FLUSH_INTERVAL_MS);
+    connect(this->flushTimer,&QTimer::timeout,this,[=]() {
+        this->flushPendingLines();
+    });
+
+    this->statsTimer = new QTimer(this);
+    this->statsTimer->setInterval(1000);
+    connect(this->statsTimer,&QTimer::timeout,this,[=]() {
+        this->updateRenderStats();
+    });
+    this->statsTimer->start();
 }
 
 ServerConsoleWidget::~ServerConsoleWidget()
@@ -26,28 +74,167 @@ void ServerConsoleWidget::setServer(BedrockServer *server)
     this->ui->commandEdit->setPlaceholderText(tr("Server command..."));
 }
 
+void ServerConsoleWidget::setLogArchive(LogArchive *archive)
+{
+    this->logArchive = archive;
+    this->ui->historyButton->setVisible(true);
+    connect(this->ui->historyButton,&QPushButton::clicked,this,[=]() {
+        this->showHistory(QDateTime::currentDateTime().addSecs(-60*60),QDateTime::currentDateTime());
+    });
+}
+
+LogHistoryDialog *ServerConsoleWidget::showHistory(QDateTime from, QDateTime to)
+{
+    // Not modal, so the search buttons keep working while it's open.
+    if (this->historyDialog==nullptr) {
+        this->historyDialog = new LogHistoryDialog(this->logArchive,from,to,this);
+    } else {
+        this->historyDialog->setRange(from,to);
+    }
+    this->historyDialog->show();
+    this->historyDialog->raise();
+    this->historyDialog->activateWindow();
+    return this->historyDialog;
+}
+
+void ServerConsoleWidget::setLogIndex(LogIndex *index)
+{
+    this->logIndex = index;
+    this->ui->searchEdit->setVisible(true);
+    this->ui->searchPrevious->setVisible(true);
+    this->ui->searchNext->setVisible(true);
+
+    connect(this->ui->searchEdit,&QLineEdit::returnPressed,this,[=]() {
+        if (this->ui->searchEdit->text().trimmed()=="") {
+            return;
+        }
+        this->ui->searchStatus->setText(tr("Searching..."));
+        this->logIndex->search(this->ui->searchEdit->text());
+    });
+    connect(this->logIndex,&LogIndex::searchFinished,this,[=](QString, QList<LogRecord> hits, qint64 elapsedNs) {
+        this->searchHits = hits;
+        if (hits.isEmpty()) {
+            this->searchHit = -1;
+            this->ui->searchStatus->setText(tr("No matches (%1 ms)").arg(elapsedNs/1000000.0,0,'f',1));
+        } else {
+            // Start at the newest, that's usually the one you're after.
+            this->showSearchHit(hits.size()-1);
+            this->ui->searchStatus->setText(this->ui->searchStatus->text()+tr(" (%1 ms)").arg(elapsedNs/1000000.0,0,'f',1));
+        }
+    });
+    connect(this->ui->searchPrevious,&QToolButton::clicked,this,[=]() {
+        if (this->searchHit>0) {
+            this->showSearchHit(this->searchHit-1);
+        }
+    });
+    connect(this->ui->searchNext,&QToolButton::clicked,this,[=]() {
+        if (this->searchHit>=0 && this->searchHit+1<this->searchHits.size()) {
+            this->showSearchHit(this->searchHit+1);
+        }
+    });
+}
+
+void ServerConsoleWidget::showSearchHit(int hit)
+{
+    this->searchHit = hit;
+    this->ui->searchStatus->setText(tr("Match %1 of %2").arg(hit+1).arg(this->searchHits.size()));
+
+    const LogRecord &record = this->searchHits.at(hit);
+    flushPendingLines();
+    int row = findConsoleRow(record);
+    if (row>=0) {
+        QModelIndex index = this->logModel->index(row);
+        this->ui->serverOutput->setCurrentIndex(index);
+        this->ui->serverOutput->scrollTo(index,QAbstractItemView::PositionAtCenter);
+    } else {
+        // Fallen out of the console, show it from the archive instead.
+        QDateTime time = QDateTime::fromMSecsSinceEpoch(record.time);
+        showHistory(time.addSecs(-HISTORY_CONTEXT_SECS),time.addSecs(HISTORY_CONTEXT_SECS))->showTime(time);
+    }
+}
+
+bool ServerConsoleWidget::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched==this->ui->serverOutput && event->type()==QEvent::KeyPress && static_cast<QKeyEvent*>(event)==QKeySequence::Copy) {
+        copySelection();
+        return true;
+    }
+    return QWidget::eventFilter(watched,event);
+}
+
+void ServerConsoleWidget::copySelection()
+{
+    QModelIndexList selected = this->ui->serverOutput->selectionModel()->selectedIndexes();
+    if (selected.isEmpty()) {
+        return;
+    }
+    // Selection order is the order rows were clicked, the clipboard wants them as shown.
+    std::sort(selected.begin(),selected.end(),[](const QModelIndex &a, const QModelIndex &b) { return a.row()<b.row(); });
+    QStringList lines;
+    for(int x=0;x<selected.size();x++) {
+        lines.append(selected.at(x).data(Qt::DisplayRole).toString());
+    }
+    QGuiApplication::clipboard()->setText(lines.join('\n'));
+}
+
+int ServerConsoleWidget::findConsoleRow(const LogRecord &record)
+{
+    // The console stamps lines when they're shown, a little after the archive does, so look
+    // forward from the archive time for the same text.
+    int row = this->logModel->rowForTime(QDateTime::fromMSecsSinceEpoch(record.time));
+    if (row<0) {
+        return -1;
+    }
+    for(;row<this->logModel->rowCount();row++) {
+        QModelIndex index = this->logModel->index(row);
+        if (index.data(ConsoleLogModel::TimeRole).toDateTime().toMSecsSinceEpoch()>record.time+1000) {
+            break;
+        }
+        if (index.data(ConsoleLogModel::MessageRole).toString()==record.text) {
+            return row;
+        }
+    }
+    return -1;
+}
+
 void ServerConsoleWidget::handleServerOutput(BedrockServer::OutputType type, QString message)
 {
-    switch (type) {
-    case BedrockServer::OutputType::ServerInfoOutput :
-       this->ui->serverOutput->appendHtml(QString("<code>%1</code>").arg(message));
-       break;
-    case BedrockServer::OutputType::InfoOutput :
-       this->ui->serverOutput->appendHtml(QString("<span style='color: #006de9;'><code>%1</code></span>").arg(message));
-       break;
-    case BedrockServer::OutputType::ErrorOutput :
-       this->ui->serverOutput->appendHtml(QString("<span style='color: #e90b00;'><code>%1</code></span>").arg(message));
-       break;
-    case BedrockServer::OutputType::WarningOutput :
-       this->ui->serverOutput->appendHtml(QString("<span style='background-color: #e90b00; color: yellow;'><code>%1</code></span>").arg(message));
-       break;
-    case BedrockServer::OutputType::ServerStatus :
-       this->ui->serverOutput->appendHtml(QString("<span style='color: #31ac0f;'><code>%1</code></span>").arg(message));
-       break;
-    default:
-        this->ui->serverOutput->appendPlainText(message);
-    }
-    this->ui->serverOutput->ensureCursorVisible();
+    this->pendingLines.append(qMakePair(type,message));
+    if (!this->flushTimer->isActive()) {
+        this->flushTimer->start();
+    }
+}
+
+void ServerConsoleWidget::flushPendingLines()
+{
+    if (this->pendingLines.isEmpty()) {
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+
+    // Only follow the output if the user hasn't scrolled back to read something.
+    QScrollBar *scroll = this->ui->serverOutput->verticalScrollBar();
+    bool atBottom = scroll->value()==scroll->maximum();
+
+    this->linesShown += this->pendingLines.size();
+    this->logModel->appendLines(this->pendingLines);
+    this->pendingLines.clear();
+    if (atBottom) {
+        this->ui->serverOutput->scrollToBottom();
+    }
+    this->flushNs += timer.nsecsElapsed();
+}
+
+void ServerConsoleWidget::updateRenderStats()
+{
+    double ms = (this->flushNs + this->lineDelegate->takePaintNs()) / 1000000.0;
+    const LogStore &store = this->logModel->getStore();
+    qint64 bytesPerLine = store.lineCount()>0 ? store.memoryUsed()/store.lineCount() : 0;
+    this->ui->renderStats->setText(tr("%Ln line(s)/s, %1 ms/s drawing, %2 bytes/line held","",this->linesShown).arg(ms,0,'f',1).arg(bytesPerLine));
+    this->ui->renderStats->setToolTip(tr("%Ln line(s) in %1 KiB","",store.lineCount()).arg(store.memoryUsed()/1024));
+    this->flushNs = 0;
+    this->linesShown = 0;
 }
 
 void ServerConsoleWidget::handleServerStateChange(BedrockServer::ServerState newState)
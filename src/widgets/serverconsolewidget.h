@@ -2,11 +2,19 @@
 #define SERVERCONSOLEWIDGET_H
 
 #include <QWidget>
+#include <QTimer>
+#include <QList>
+#include <QPair>
 #include <server/bedrockserver.h>
+#include <logging/logarchive.h>
+#include <logging/logindex.h>
+#include "consolelogmodel.h"
+#include "consolelinedelegate.h"
 
 namespace Ui {
 class ServerConsoleWidget;
 }
+class LogHistoryDialog;
 
 class ServerConsoleWidget : public QWidget
 {
@@ -17,9 +25,34 @@ public:
     ~ServerConsoleWidget();
 
     void setServer(BedrockServer *server);
+    void setLogArchive(LogArchive *archive);
+    void setLogIndex(LogIndex *index);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
     Ui::ServerConsoleWidget *ui;
     BedrockServer *server;
+    LogArchive *logArchive;
+    LogIndex *logIndex;
+    LogHistoryDialog *historyDialog; // Created when first needed, then reused
+    QList<LogRecord> searchHits;
+    int searchHit;
+    ConsoleLogModel *logModel;
+    ConsoleLineDelegate *lineDelegate;
+    QList<QPair<BedrockServer::OutputType,QString>> pendingLines;
+    QTimer *flushTimer;
+    QTimer *statsTimer;
+    qint64 flushNs;
+    int linesShown;
+
+    void flushPendingLines();
+    void updateRenderStats();
+    void showSearchHit(int hit);
+    LogHistoryDialog *showHistory(QDateTime from, QDateTime to);
+    int findConsoleRow(const LogRecord &record);
+    void copySelection();
 private slots:
     void handleServerOutput(BedrockServer::OutputType type, QString message);
     void handleServerStateChange(BedrockServer::ServerState newState);
@@ -0,0 +1,251 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "serverpropertiesmodel.h"
+#include <QComboBox>
+#include <QLineEdit>
+#include <QIntValidator>
+#include <QDoubleValidator>
+#include <QColor>
+#include <QSet>
+#include <limits>
+
+ServerPropertiesModel::ServerPropertiesModel(ServerConfigStore *store, QObject *parent)
+    : QAbstractTableModel(parent),store(store)
+{
+    const QList<ServerConfigStore::Entry*> entries = store->entries();
+    for(int x=0;x<entries.size();x++) {
+        this->rows.append(entries.at(x)->name);
+    }
+    indexRows();
+    connect(store,&ServerConfigStore::changed,this,&ServerPropertiesModel::storeChanged);
+}
+
+int ServerPropertiesModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : this->rows.size();
+}
+
+int ServerPropertiesModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ServerPropertiesModel::data(const QModelIndex &index, int role) const
+{
+    ServerConfigStore::Entry *entry = entryAt(index);
+    if (!entry) {
+        return QVariant();
+    }
+    bool pending = !entry->newValue.isNull();
+    if (role==Qt::ToolTipRole) {
+        QString problem = (pending && index.column()==ValueColumn) ? ServerConfigStore::validate(entry->name,entry->newValue) : QString();
+        return problem.isEmpty() ? entry->help.trimmed() : tr("%1 %2.").arg(entry->name,problem);
+    }
+    if (index.column()==NameColumn) {
+        return (role==Qt::DisplayRole) ? QVariant(entry->name) : QVariant();
+    }
+    switch (role) {
+        case Qt::DisplayRole :
+        case Qt::EditRole :
+            return pending ? entry->newValue.toString() : entry->value.toString();
+        case Qt::ForegroundRole :
+            if (!pending) {
+                return QVariant();
+            }
+            // Blue waiting to be saved, red if saving it would be refused.
+            return ServerConfigStore::validate(entry->name,entry->newValue).isEmpty() ? QColor(Qt::blue) : QColor(Qt::red);
+    }
+    return QVariant();
+}
+
+bool ServerPropertiesModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    ServerConfigStore::Entry *entry = entryAt(index);
+    if (!entry || role!=Qt::EditRole || index.column()!=ValueColumn) {
+        return false;
+    }
+    QString text = value.toString();
+    entry->newValue = (text==entry->value.toString()) ? QVariant() : QVariant(text);
+    emit dataChanged(index.siblingAtColumn(NameColumn),index.siblingAtColumn(ValueColumn));
+    return true;
+}
+
+Qt::ItemFlags ServerPropertiesModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags flags = QAbstractTableModel::flags(index);
+    if (index.column()==ValueColumn && entryAt(index)) {
+        flags |= Qt::ItemIsEditable;
+    }
+    return flags;
+}
+
+QVariant ServerPropertiesModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation!=Qt::Horizontal || role!=Qt::DisplayRole) {
+        return QVariant();
+    }
+    return (section==NameColumn) ? tr("Setting") : tr("Value");
+}
+
+ServerConfigStore::Entry *ServerPropertiesModel::entryAt(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.row()>=this->rows.size()) {
+        return nullptr;
+    }
+    return this->store->entry(this->rows.at(index.row()));
+}
+
+void ServerPropertiesModel::storeChanged(QStringList names)
+{
+    QStringList current;
+    const QList<ServerConfigStore::Entry*> entries = this->store->entries();
+    for(int x=0;x<entries.size();x++) {
+        current.append(entries.at(x)->name);
+    }
+    QSet<QString> inStore(current.constBegin(),current.constEnd());
+
+    // Settings that have gone, removed in runs from the bottom.
+    for(int row=this->rows.size()-1;row>=0;) {
+        if (inStore.contains(this->rows.at(row))) {
+            row--;
+            continue;
+        }
+        int last = row;
+        while (row>=0 && !inStore.contains(this->rows.at(row))) {
+            row--;
+        }
+        beginRemoveRows(QModelIndex(),row+1,last);
+        this->rows.erase(this->rows.begin()+row+1,this->rows.begin()+last+1);
+        endRemoveRows();
+    }
+
+    // New settings go where the file has them. Settings moving around in the file is rare
+    // enough to just start again.
+    QSet<QString> shown(this->rows.constBegin(),this->rows.constEnd());
+    QStringList kept;
+    for(int x=0;x<current.size();x++) {
+        if (shown.contains(current.at(x))) {
+            kept.append(current.at(x));
+        }
+    }
+    if (kept!=this->rows) {
+        beginResetModel();
+        this->rows = current;
+        indexRows();
+        endResetModel();
+        return;
+    }
+    for(int x=0;x<current.size();) {
+        if (shown.contains(current.at(x))) {
+            x++;
+            continue;
+        }
+        int first = x;
+        while (x<current.size() && !shown.contains(current.at(x))) {
+            x++;
+        }
+        beginInsertRows(QModelIndex(),first,x-1);
+        for(int y=first;y<x;y++) {
+            this->rows.insert(y,current.at(y));
+        }
+        endInsertRows();
+    }
+    indexRows();
+
+    for(int x=0;x<names.size();x++) {
+        int row = this->rowOf.value(names.at(x),-1);
+        if (row>=0) {
+            emit dataChanged(index(row,NameColumn),index(row,ValueColumn));
+        }
+    }
+}
+
+void ServerPropertiesModel::indexRows()
+{
+    this->rowOf.clear();
+    for(int x=0;x<this->rows.size();x++) {
+        this->rowOf.insert(this->rows.at(x),x);
+    }
+}
+
+ServerPropertyDelegate::ServerPropertyDelegate(QObject *parent) : QStyledItemDelegate(parent)
+{
+}
+
+QWidget *ServerPropertyDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &, const QModelIndex &index) const
+{
+    const ServerPropertiesModel *model = qobject_cast<const ServerPropertiesModel*>(index.model());
+    ServerConfigStore::Entry *entry = model ? model->entryAt(index) : nullptr;
+    if (!entry) {
+        return nullptr;
+    }
+    QStringList values = (entry->type==ServerConfigStore::Boolean) ? QStringList({"true","false"}) : entry->possibleValues;
+    if (!values.isEmpty()) {
+        QComboBox *valueBox = new QComboBox(parent);
+        valueBox->addItems(values);
+        // Choosing a value is the whole edit.
+        connect(valueBox,&QComboBox::activated,this,&ServerPropertyDelegate::commitValue);
+        return valueBox;
+    }
+
+    QLineEdit *valueEdit = new QLineEdit(parent);
+    const ServerConfigStore::Schema *schema = ServerConfigStore::schema(entry->name);
+    if (schema && schema->type==ServerConfigStore::Integer) {
+        int bottom = qMax(schema->minimum,(double)std::numeric_limits<int>::min());
+        int top = qMin(schema->maximum,(double)std::numeric_limits<int>::max());
+        valueEdit->setValidator(new QIntValidator(bottom,top,valueEdit));
+    } else if (schema && schema->type==ServerConfigStore::Float) {
+        QDoubleValidator *validator = new QDoubleValidator(schema->minimum,schema->maximum,-1,valueEdit);
+        validator->setLocale(QLocale::c()); // The file always uses a '.'
+        valueEdit->setValidator(validator);
+    }
+    return valueEdit;
+}
+
+void ServerPropertyDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+    QString text = index.data(Qt::EditRole).toString();
+    QComboBox *valueBox = qobject_cast<QComboBox*>(editor);
+    if (valueBox) {
+        if (valueBox->findText(text)<0) {
+            valueBox->addItem(text); // Whatever the file has, even if the server won't take it
+        }
+        valueBox->setCurrentText(text);
+        return;
+    }
+    QLineEdit *valueEdit = qobject_cast<QLineEdit*>(editor);
+    if (valueEdit) {
+        valueEdit->setText(text);
+    }
+}
+
+void ServerPropertyDelegate::commitValue()
+{
+    QWidget *editor = qobject_cast<QWidget*>(sender());
+    if (editor) {
+        emit commitData(editor);
+    }
+}
+
+void ServerPropertyDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+    QComboBox *valueBox = qobject_cast<QComboBox*>(editor);
+    if (valueBox) {
+        model->setData(index,valueBox->currentText());
+        return;
+    }
+    QLineEdit *valueEdit = qobject_cast<QLineEdit*>(editor);
+    if (valueEdit) {
+        model->setData(index,valueEdit->text());
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef SERVERPROPERTIESMODEL_H
+#define SERVERPROPERTIESMODEL_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+#include <QHash>
+#include <server/serverconfigstore.h>
+
+// One row per setting in server.properties, following the config store. When the store
+// changes only the rows affected are inserted, removed or updated, so views keep their
+// scroll position and edits that haven't been saved yet stay in the store until they are.
+class ServerPropertiesModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit ServerPropertiesModel(ServerConfigStore *store, QObject *parent = nullptr);
+
+    enum Column { NameColumn,ValueColumn,ColumnCount };
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    ServerConfigStore::Entry *entryAt(const QModelIndex &index) const; // nullptr if the setting has just gone
+
+private:
+    ServerConfigStore *store;
+    QStringList rows; // Setting names, in file order
+    QHash<QString,int> rowOf;
+
+    void storeChanged(QStringList names);
+    void indexRows();
+};
+
+// Edits a value with a combo box for settings with a fixed set of values, and a line edit
+// checked against the setting's type otherwise. Only made for the value being edited.
+class ServerPropertyDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit ServerPropertyDelegate(QObject *parent = nullptr);
+
+    QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    void setEditorData(QWidget *editor, const QModelIndex &index) const override;
+    void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const override;
+
+private slots:
+    void commitValue();
+};
+
+#endif // SERVERPROPERTIESMODEL_H
@@ -0,0 +1,91 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "sparklinewidget.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QMouseEvent>
+#include <algorithm>
+
+SparklineWidget::SparklineWidget(QString title, QString unit, QWidget *parent)
+    : QWidget(parent),title(title),unit(unit),current(0),hasData(false),resolution(TelemetrySeries::Recent)
+{
+    setToolTip(tr("Last five minutes, click for the last hour or day."));
+}
+
+void SparklineWidget::setSeries(const TelemetrySeries &series)
+{
+    this->values = series.values(this->resolution);
+    this->current = series.last();
+    this->hasData = !series.isEmpty();
+    update();
+}
+
+TelemetrySeries::Resolution SparklineWidget::getResolution()
+{
+    return this->resolution;
+}
+
+QSize SparklineWidget::sizeHint() const
+{
+    return QSize(140,fontMetrics().height()*3);
+}
+
+void SparklineWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QRect area = rect().adjusted(1,1,-1,-1);
+    painter.fillRect(area,palette().base());
+    painter.setPen(palette().mid().color());
+    painter.drawRect(area);
+
+    QString label = this->hasData ? QString("%1 %2 %3").arg(this->title).arg(this->current,0,'f',this->current<10 ? 1 : 0).arg(this->unit)
+                                  : QString("%1 -").arg(this->title);
+    painter.setPen(palette().text().color());
+    painter.drawText(area.adjusted(3,1,-3,-1),Qt::AlignLeft|Qt::AlignTop,label);
+
+    if (this->values.size()<2) {
+        return;
+    }
+    // Scale to the largest value shown, always from zero so small wobbles stay small.
+    double top = *std::max_element(this->values.begin(),this->values.end());
+    if (top<=0) {
+        top = 1;
+    }
+    QRectF chart = QRectF(area).adjusted(2,fontMetrics().height()+2,-2,-2);
+    QPainterPath path;
+    for(int x=0;x<this->values.size();x++) {
+        QPointF point(chart.left()+chart.width()*x/(this->values.size()-1),
+                      chart.bottom()-chart.height()*this->values.at(x)/top);
+        if (x==0) {
+            path.moveTo(point);
+        } else {
+            path.lineTo(point);
+        }
+    }
+    painter.setPen(QPen(QColor(0x006de9),1.5));
+    painter.drawPath(path);
+}
+
+void SparklineWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button()!=Qt::LeftButton) {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    this->resolution = (TelemetrySeries::Resolution)((this->resolution+1) % TelemetrySeries::ResolutionCount);
+    setToolTip(this->resolution==TelemetrySeries::Recent ? tr("Last five minutes, click for the last hour or day.") :
+               this->resolution==TelemetrySeries::Hour ? tr("Last hour, click for the last day or five minutes.")
+                                                       : tr("Last day, click for the last five minutes or hour."));
+    emit resolutionChanged(this->resolution);
+}
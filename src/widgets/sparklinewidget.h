@@ -0,0 +1,48 @@
+#ifndef SPARKLINEWIDGET_H
+#define SPARKLINEWIDGET_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QWidget>
+#include <QList>
+#include <telemetry/telemetryseries.h>
+
+// A small line chart of one series with its latest value. Clicking steps through the
+// series' resolutions.
+class SparklineWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SparklineWidget(QString title, QString unit, QWidget *parent = nullptr);
+
+    void setSeries(const TelemetrySeries &series);
+    TelemetrySeries::Resolution getResolution();
+    QSize sizeHint() const override;
+
+signals:
+    void resolutionChanged(TelemetrySeries::Resolution resolution);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    QString title;
+    QString unit;
+    QList<double> values;
+    double current;
+    bool hasData;
+    TelemetrySeries::Resolution resolution;
+};
+
+#endif // SPARKLINEWIDGET_H
@@ -0,0 +1,341 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "fakeserver.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <iostream>
+#include <string>
+
+#define XUID_BASE 2535400000000000ULL
+
+FakeServer::FakeServer(Options options) : options(options),random(options.seed),nextPlayer(0),nextTableNumber(0),holding(false),pollsLeft(0)
+{
+    this->out.open(stdout,QIODevice::WriteOnly|QIODevice::Unbuffered);
+}
+
+int FakeServer::run()
+{
+    writeDefaultFiles();
+    generateWorld();
+    startup();
+
+    std::string input;
+    while (std::getline(std::cin,input)) {
+        QString command = QString::fromLocal8Bit(input.c_str()).trimmed();
+        if (!handleCommand(command)) {
+            return 0;
+        }
+    }
+    // stdin closed, the console has gone away.
+    return 0;
+}
+
+QString FakeServer::worldPath()
+{
+    return QDir(this->options.root).filePath("worlds/"+this->options.levelName);
+}
+
+void FakeServer::print(QString message, QString level)
+{
+    printRaw(QString("[%1 %2] %3").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss:zzz")).arg(level).arg(message));
+}
+
+void FakeServer::printRaw(QString line)
+{
+    // The real server always ends lines with \r\n
+    this->out.write((line+"\r\n").toUtf8());
+}
+
+void FakeServer::startup()
+{
+    QStringList lines = {
+        "Starting Server",
+        "Version: 1.21.44.01",
+        "Session ID: 00000000-0000-0000-0000-000000000000",
+        "Build ID: 0",
+        "Branch: fake",
+        "Configuration: Publish",
+        QString("Level Name: %1").arg(this->options.levelName),
+        "Game mode: 0 Survival",
+        "Difficulty: 1 EASY",
+        "Content logging to console is enabled.",
+        QString("Opening level 'worlds/%1/db'").arg(this->options.levelName),
+        "IPv4 supported, port: 19132: Used for gameplay and LAN discovery",
+        "IPv6 supported, port: 19133: Used for gameplay",
+    };
+
+    printRaw("NO LOG FILE! - setting up server logging...");
+    for(int x=0;x<lines.size();x++) {
+        print(lines[x]);
+        QThread::msleep(this->options.startupMs / lines.size());
+    }
+    print("Server started.");
+    connectPlayers(this->options.players);
+}
+
+bool FakeServer::handleCommand(QString command)
+{
+    QStringList bits = command.split(' ',Qt::SkipEmptyParts);
+    if (bits.isEmpty()) {
+        return true;
+    }
+    QString verb = bits[0].toLower();
+
+    if (command=="stop") {
+        print("Server stop requested.");
+        disconnectPlayers(this->online.size());
+        print("Stopping server...");
+        printRaw("Quit correctly");
+        return false;
+    } else if (command=="save hold") {
+        if (this->holding) {
+            printRaw("The command is already running");
+        } else {
+            this->holding = true;
+            this->pollsLeft = this->options.savePolls;
+            printRaw("Saving...");
+        }
+    } else if (command=="save query") {
+        if (this->holding && this->pollsLeft>0) {
+            this->pollsLeft--;
+            printRaw("A previous save has not been completed.");
+        } else if (this->holding) {
+            // One write, the console expects the file list to arrive with this line.
+            printRaw("Data saved. Files are now ready to be copied.\r\n"+worldFileList().join(", "));
+        } else {
+            printRaw("A previous save has not been completed.");
+        }
+    } else if (command=="save resume") {
+        printRaw("Changes to the level are resumed.");
+        if (this->holding) {
+            this->holding = false;
+            churnWorld();
+        }
+    } else if (command=="permission list") {
+        permissionList();
+    } else if (command=="permission reload") {
+        print("Permissions reloaded.");
+    } else if (verb=="list") {
+        QStringList names;
+        for(int x=0;x<this->online.size();x++) {
+            names << this->online[x].first;
+        }
+        printRaw(QString("There are %1/%2 players online:").arg(this->online.size()).arg(this->options.maxPlayers));
+        printRaw(names.join(", "));
+    } else if (verb=="op" && bits.size()>1) {
+        printRaw(QString("Opped: %1").arg(bits[1]));
+    } else if (verb=="deop" && bits.size()>1) {
+        printRaw(QString("De-opped: %1").arg(bits[1]));
+    } else if (verb=="say") {
+        printRaw(QString("[Server] %1").arg(command.mid(4)));
+    } else if (verb=="difficulty" && bits.size()>1) {
+        printRaw(QString("Set game difficulty to %1").arg(bits[1]));
+    } else if (verb=="kick" && bits.size()>1) {
+        for(int x=0;x<this->online.size();x++) {
+            if (this->online[x].first==bits[1]) {
+                this->online.move(x,this->online.size()-1);
+                disconnectPlayers(1);
+                printRaw(QString("Kicked %1 from the game").arg(bits[1]));
+                break;
+            }
+        }
+    } else if (verb=="fake" && bits.size()>2) {
+        // Not real server commands, these drive load for benchmarks.
+        int count = bits[2].toInt();
+        if (bits[1]=="join") {
+            connectPlayers(count);
+        } else if (bits[1]=="leave") {
+            disconnectPlayers(count);
+        } else if (bits[1]=="spam") {
+            QString text = (bits.size()>3) ? bits.mid(3).join(' ') : "[Scripting] fake add-on output";
+            for(int x=0;x<count;x++) {
+                print(QString("%1 %2").arg(text).arg(x));
+            }
+        }
+    } else {
+        printRaw(QString("Unknown command: %1. Please check that the command exists and that you have permission to use it.").arg(bits[0]));
+    }
+    return true;
+}
+
+void FakeServer::generateWorld()
+{
+    QDir db(worldPath()+"/db");
+    if (db.exists() && !this->options.regenerate) {
+        // Carry on numbering from the existing tables.
+        QStringList tables = db.entryList(QStringList() << "*.ldb",QDir::Files,QDir::Name);
+        this->nextTableNumber = tables.isEmpty() ? 5 : tables.last().left(6).toInt()+1;
+        return;
+    }
+    if (db.exists()) {
+        QDir(worldPath()).removeRecursively();
+    }
+    QDir().mkpath(db.path());
+
+    qint64 tableSize = (qint64(this->options.worldMiB) * 1024 * 1024) / qMax(1,this->options.worldFiles);
+    this->nextTableNumber = 5;
+    for(int x=0;x<this->options.worldFiles;x++) {
+        writeRandomFile(db.filePath(QString("%1.ldb").arg(this->nextTableNumber,6,10,QChar('0'))),tableSize/2 + this->random.bounded(tableSize+1));
+        this->nextTableNumber += 3;
+    }
+    writeRandomFile(db.filePath(QString("%1.log").arg(this->nextTableNumber++,6,10,QChar('0'))),64*1024);
+    writeRandomFile(db.filePath("MANIFEST-000002"),16*1024);
+    QFile current(db.filePath("CURRENT"));
+    if (current.open(QIODevice::WriteOnly)) {
+        current.write("MANIFEST-000002\n");
+    }
+    writeRandomFile(worldPath()+"/level.dat",2873);
+    QFile::copy(worldPath()+"/level.dat",worldPath()+"/level.dat_old");
+    QFile levelName(worldPath()+"/levelname.txt");
+    if (levelName.open(QIODevice::WriteOnly)) {
+        levelName.write(this->options.levelName.toUtf8());
+    }
+}
+
+void FakeServer::writeRandomFile(QString path, qint64 size)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly|QIODevice::Truncate)) {
+        return;
+    }
+    // Random data, table files are compressed so shouldn't zip well either.
+    QList<quint32> block(256*1024);
+    while (size>0) {
+        this->random.fillRange(block.data(),block.size());
+        qint64 chunk = qMin<qint64>(size,block.size()*sizeof(quint32));
+        file.write((const char*)block.constData(),chunk);
+        size -= chunk;
+    }
+}
+
+void FakeServer::churnWorld()
+{
+    QDir db(worldPath()+"/db");
+    QStringList tables = db.entryList(QStringList() << "*.ldb",QDir::Files,QDir::Name);
+    if (tables.isEmpty()) {
+        return;
+    }
+
+    qint64 tableSize = (qint64(this->options.worldMiB) * 1024 * 1024) / qMax(1,this->options.worldFiles);
+    for(int x=0;x<this->options.churnFiles;x++) {
+        QString table = tables[this->random.bounded(tables.size())];
+        writeRandomFile(db.filePath(table),tableSize/2 + this->random.bounded(tableSize+1));
+    }
+    if ((int)this->random.bounded(100) < this->options.compactionPercent) {
+        // Compaction, an old table goes and a new one appears.
+        QString victim = tables[this->random.bounded(tables.size())];
+        db.remove(victim);
+        writeRandomFile(db.filePath(QString("%1.ldb").arg(this->nextTableNumber,6,10,QChar('0'))),tableSize/2 + this->random.bounded(tableSize+1));
+        this->nextTableNumber += 3;
+    }
+}
+
+QStringList FakeServer::worldFileList()
+{
+    // Paths relative to the worlds folder, with the size to copy.
+    QStringList files;
+    QDir worlds(QDir(this->options.root).filePath("worlds"));
+    QStringList folders = {this->options.levelName+"/db",this->options.levelName};
+    for(int x=0;x<folders.size();x++) {
+        QFileInfoList entries = QDir(worlds.filePath(folders[x])).entryInfoList(QDir::Files,QDir::Name);
+        for(int y=0;y<entries.size();y++) {
+            files << QString("%1/%2:%3").arg(folders[x]).arg(entries[y].fileName()).arg(entries[y].size());
+        }
+    }
+    return files;
+}
+
+void FakeServer::permissionList()
+{
+    QFile permissions(QDir(this->options.root).filePath("permissions.json"));
+    QJsonArray result;
+    if (permissions.open(QIODevice::ReadOnly)) {
+        result = QJsonDocument::fromJson(permissions.readAll()).array();
+    }
+    QJsonObject response;
+    response.insert("command","permissions");
+    response.insert("result",result);
+    printRaw("###* "+QString::fromUtf8(QJsonDocument(response).toJson(QJsonDocument::Compact)));
+    printRaw(" *###");
+}
+
+void FakeServer::connectPlayers(int count)
+{
+    for(int x=0;x<count;x++) {
+        QString name = QString("FakePlayer%1").arg(this->nextPlayer);
+        QString xuid = QString::number(XUID_BASE + this->nextPlayer);
+        this->nextPlayer++;
+        this->online.append(QPair<QString,QString>(name,xuid));
+        print(QString("Player connected: %1, xuid: %2").arg(name).arg(xuid));
+        print(QString("Player Spawned: %1 xuid: %2, pfid: %3").arg(name).arg(xuid).arg(this->random.generate64(),16,16,QChar('0')));
+    }
+}
+
+void FakeServer::disconnectPlayers(int count)
+{
+    for(int x=0;x<count && !this->online.isEmpty();x++) {
+        QPair<QString,QString> player = this->online.takeLast();
+        print(QString("Player disconnected: %1, xuid: %2, pfid: %3").arg(player.first).arg(player.second).arg(this->random.generate64(),16,16,QChar('0')));
+    }
+}
+
+void FakeServer::writeDefaultFiles()
+{
+    QDir root(this->options.root);
+
+    QFile properties(root.filePath("server.properties"));
+    if (!properties.exists() && properties.open(QIODevice::WriteOnly|QIODevice::Text)) {
+        properties.write(QString(
+            "server-name=Fake Server\n"
+            "# Used as the server name\n"
+            "gamemode=survival\n"
+            "# Sets the game mode for new players.\n"
+            "difficulty=easy\n"
+            "# Sets the difficulty of the world.\n"
+            "max-players=%1\n"
+            "# The maximum number of players that can play on the server.\n"
+            "online-mode=true\n"
+            "allow-list=false\n"
+            "server-port=19132\n"
+            "server-portv6=19133\n"
+            "view-distance=32\n"
+            "tick-distance=4\n"
+            "player-idle-timeout=30\n"
+            "max-threads=8\n"
+            "level-name=%2\n"
+            "default-player-permission-level=member\n"
+            ).arg(this->options.maxPlayers).arg(this->options.levelName).toUtf8());
+    }
+
+    QFile permissions(root.filePath("permissions.json"));
+    if (!permissions.exists() && permissions.open(QIODevice::WriteOnly)) {
+        QJsonArray known;
+        for(int x=0;x<this->options.knownPlayers;x++) {
+            QJsonObject entry;
+            entry.insert("permission",(x%10==0) ? "operator" : (x%10==9) ? "visitor" : "member");
+            entry.insert("xuid",QString::number(XUID_BASE + x));
+            known.append(entry);
+        }
+        permissions.write(QJsonDocument(known).toJson());
+    }
+
+    QFile allowlist(root.filePath("allowlist.json"));
+    if (!allowlist.exists() && allowlist.open(QIODevice::WriteOnly)) {
+        allowlist.write("[]\n");
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef FAKESERVER_H
+#define FAKESERVER_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QRandomGenerator>
+
+// Stands in for bedrock_server. Talks the same stdin/stdout protocol as far as the
+// console cares, and keeps a synthetic LevelDB-like world that changes between saves.
+class FakeServer
+{
+public:
+    class Options {
+    public:
+        QString root;
+        QString levelName = "Bedrock level";
+        int worldMiB = 64; // Total size of the generated world.
+        int worldFiles = 40; // Number of .ldb table files.
+        int churnFiles = 4; // Files rewritten after each save resume.
+        int compactionPercent = 25; // Chance a save resume also replaces a table file.
+        int savePolls = 1; // 'save query' calls answered 'not completed' before the files are ready.
+        int startupMs = 500; // Spread over the startup lines.
+        int players = 0; // Connected once the server has started.
+        int knownPlayers = 100; // Written to permissions.json if it doesn't exist.
+        int maxPlayers = 10;
+        bool regenerate = false;
+        quint32 seed = 1;
+    };
+
+    explicit FakeServer(Options options);
+
+    int run(); // Returns the exit code.
+
+private:
+    Options options;
+    QFile out;
+    QRandomGenerator random;
+    QList<QPair<QString,QString>> online; // name, xuid
+    int nextPlayer;
+    int nextTableNumber;
+    bool holding;
+    int pollsLeft;
+    QString worldPath();
+
+    void print(QString message, QString level = "INFO");
+    void printRaw(QString line);
+    void startup();
+    bool handleCommand(QString command); // False when the server should exit.
+    void generateWorld();
+    void writeRandomFile(QString path, qint64 size);
+    void churnWorld();
+    QStringList worldFileList();
+    void permissionList();
+    void connectPlayers(int count);
+    void disconnectPlayers(int count);
+    void writeDefaultFiles();
+};
+
+#endif // FAKESERVER_H
@@ -0,0 +1,14 @@
+QT       += core
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+# The console looks for this name in the server folder.
+TARGET = bedrock_server
+
+SOURCES += \
+    fakeserver.cpp \
+    main.cpp
+
+HEADERS += \
+    fakeserver.h
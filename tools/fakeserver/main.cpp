@@ -0,0 +1,73 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "fakeserver.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSettings>
+#include <QDir>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+#ifdef Q_OS_WIN
+    // We write \r\n ourselves.
+    _setmode(_fileno(stdout),_O_BINARY);
+#endif
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Imitates bedrock_server for testing and benchmarking the console. "
+                                     "The console starts it without arguments, so settings are also read from fakeserver.ini in the server folder.");
+    parser.addHelpOption();
+    QCommandLineOption rootOption("root","Server folder, defaults to the folder this program is in.","folder");
+    QCommandLineOption worldOption("world-mib","Size of the generated world.","MiB");
+    QCommandLineOption filesOption("world-files","Number of table files in the world.","count");
+    QCommandLineOption churnOption("churn-files","Table files rewritten after each backup.","count");
+    QCommandLineOption compactionOption("compaction-percent","Chance of a table being replaced after each backup.","percent");
+    QCommandLineOption pollsOption("save-polls","'save query' calls before the files are ready.","count");
+    QCommandLineOption startupOption("startup-ms","How long startup takes.","ms");
+    QCommandLineOption playersOption("players","Players to connect once started.","count");
+    QCommandLineOption knownOption("known-players","Players in a newly created permissions.json.","count");
+    QCommandLineOption regenerateOption("regenerate","Throw away and regenerate the world.");
+    QCommandLineOption seedOption("seed","Random seed.","seed");
+    parser.addOptions({rootOption,worldOption,filesOption,churnOption,compactionOption,pollsOption,startupOption,playersOption,knownOption,regenerateOption,seedOption});
+    parser.process(a);
+
+    FakeServer::Options options;
+    options.root = parser.isSet(rootOption) ? parser.value(rootOption) : QCoreApplication::applicationDirPath();
+
+    // Defaults from the ini file, then anything given on the command line.
+    QSettings ini(QDir(options.root).filePath("fakeserver.ini"),QSettings::IniFormat);
+    auto value = [&](QCommandLineOption &option, int current) {
+        QString name = option.names().first();
+        return parser.isSet(option) ? parser.value(option).toInt() : ini.value(name,current).toInt();
+    };
+    options.worldMiB = value(worldOption,options.worldMiB);
+    options.worldFiles = value(filesOption,options.worldFiles);
+    options.churnFiles = value(churnOption,options.churnFiles);
+    options.compactionPercent = value(compactionOption,options.compactionPercent);
+    options.savePolls = value(pollsOption,options.savePolls);
+    options.startupMs = value(startupOption,options.startupMs);
+    options.players = value(playersOption,options.players);
+    options.knownPlayers = value(knownOption,options.knownPlayers);
+    options.seed = value(seedOption,options.seed);
+    options.regenerate = parser.isSet(regenerateOption) || ini.value("regenerate",false).toBool();
+
+    FakeServer server(options);
+    return server.run();
+}
@@ -0,0 +1,139 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "lifecyclebenchmark.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTimer>
+
+LifecycleBenchmark::LifecycleBenchmark(QString serverRoot, QObject *parent) : QObject(parent),serverRoot(serverRoot),backupCount(3),stormSize(80)
+{
+}
+
+void LifecycleBenchmark::setBackupCount(int count)
+{
+    this->backupCount = count;
+}
+
+void LifecycleBenchmark::setStormSize(int players)
+{
+    this->stormSize = players;
+}
+
+bool LifecycleBenchmark::run()
+{
+    QTextStream out(stdout);
+    BedrockServer server;
+    server.setServerRootFolder(this->serverRoot);
+
+    int connected = 0;
+    int disconnected = 0;
+    int stops = 0;
+    bool backupDone = false;
+    bool backupFailed = false;
+    QString zipFile;
+    QElapsedTimer holdTimer;
+    qint64 holdMs = 0;
+
+    connect(&server,&BedrockServer::playerConnected,this,[&](QString, QString) { connected++; });
+    connect(&server,&BedrockServer::playerDisconnected,this,[&](QString, QString) { disconnected++; });
+    connect(&server,&BedrockServer::serverStateChanged,this,[&](BedrockServer::ServerState state) {
+        if (state==BedrockServer::ServerStopped) {
+            stops++;
+        }
+    });
+    connect(&server,&BedrockServer::backupStarting,this,[&]() {
+        if (!holdTimer.isValid()) {
+            holdTimer.start();
+        }
+    });
+    connect(&server,&BedrockServer::backupFinishedOnServer,this,[&]() { holdMs = holdTimer.elapsed(); });
+    connect(&server,&BedrockServer::backupFinished,this,[&](QString zip) {
+        zipFile = zip;
+        backupDone = true;
+    });
+    connect(&server,&BedrockServer::backupFailed,this,[&]() { backupFailed = true; });
+
+    QElapsedTimer timer;
+    out << "Server folder: " << this->serverRoot << Qt::endl;
+
+    timer.start();
+    server.startServer();
+    if (!waitFor([&]() { return server.GetCurrentState()==BedrockServer::ServerRunning; },120000)) {
+        out << "  server did not start" << Qt::endl;
+        return false;
+    }
+    out << "  start:          " << timer.elapsed() << " ms" << Qt::endl;
+
+    for(int x=0;x<this->backupCount;x++) {
+        backupDone = false;
+        backupFailed = false;
+        holdTimer.invalidate();
+        timer.restart();
+        server.startBackup();
+        if (!waitFor([&]() { return backupDone || backupFailed; },600000) || backupFailed) {
+            out << "  backup " << (x+1) << " failed" << Qt::endl;
+            return false;
+        }
+        out << "  backup " << (x+1) << ":       " << timer.elapsed() << " ms, held for " << holdMs << " ms, "
+            << QFileInfo(zipFile).size() / 1024 << " KiB zip" << Qt::endl;
+        server.completeBackup();
+    }
+
+    connected = 0;
+    disconnected = 0;
+    timer.restart();
+    server.sendCommandToServer(QString("fake join %1").arg(this->stormSize));
+    if (!waitFor([&]() { return connected>=this->stormSize; },60000)) {
+        out << "  player storm timed out, " << connected << " connected" << Qt::endl;
+        return false;
+    }
+    out << "  join storm:     " << this->stormSize << " players in " << timer.elapsed() << " ms" << Qt::endl;
+    timer.restart();
+    server.sendCommandToServer(QString("fake leave %1").arg(this->stormSize));
+    waitFor([&]() { return disconnected>=this->stormSize; },60000);
+    out << "  leave storm:    " << disconnected << " players in " << timer.elapsed() << " ms" << Qt::endl;
+
+    timer.restart();
+    server.stopAndRestartServer();
+    if (!waitFor([&]() { return stops>0 && server.GetCurrentState()==BedrockServer::ServerRunning; },120000)) {
+        out << "  restart timed out" << Qt::endl;
+        return false;
+    }
+    out << "  restart:        " << timer.elapsed() << " ms" << Qt::endl;
+
+    timer.restart();
+    server.stopServer();
+    if (!waitFor([&]() { return server.GetCurrentState()==BedrockServer::ServerStopped; },60000)) {
+        out << "  stop timed out" << Qt::endl;
+        return false;
+    }
+    out << "  stop:           " << timer.elapsed() << " ms" << Qt::endl;
+    return true;
+}
+
+bool LifecycleBenchmark::waitFor(std::function<bool ()> done, int timeoutMs)
+{
+    QElapsedTimer timer;
+    QTimer wakeUp; // So the timeout is noticed even when nothing else happens.
+    timer.start();
+    wakeUp.start(50);
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
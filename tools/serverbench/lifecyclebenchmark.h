@@ -0,0 +1,40 @@
+#ifndef LIFECYCLEBENCHMARK_H
+#define LIFECYCLEBENCHMARK_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <functional>
+#include <server/bedrockserver.h>
+
+// Drives a real BedrockServer against a server folder, normally one holding the fake
+// bedrock_server from tools/fakeserver, and times start, backups, a player storm and a restart.
+class LifecycleBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LifecycleBenchmark(QString serverRoot, QObject *parent = nullptr);
+
+    void setBackupCount(int count);
+    void setStormSize(int players);
+    bool run(); // Prints a report, false if any step timed out.
+
+private:
+    QString serverRoot;
+    int backupCount;
+    int stormSize;
+
+    bool waitFor(std::function<bool()> done, int timeoutMs);
+};
+
+#endif // LIFECYCLEBENCHMARK_H
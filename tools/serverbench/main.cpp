@@ -0,0 +1,171 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "replaybenchmark.h"
+#include "lifecyclebenchmark.h"
+#include "modelbenchmark.h"
+#include "stormbenchmark.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<quint64> allocations(0);
+static bool verbose = false;
+
+quint64 allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+// Qt's containers allocate with malloc directly, so count there. operator new ends up here too.
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    allocations.fetch_add(1,std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    allocations.fetch_add(1,std::memory_order_relaxed);
+    return __libc_calloc(count,size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    allocations.fetch_add(1,std::memory_order_relaxed);
+    return __libc_realloc(ptr,size);
+}
+#else
+// Elsewhere only allocations made through operator new are seen.
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1,std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+#endif
+
+static void messageHandler(QtMsgType type, const QMessageLogContext &, const QString &message)
+{
+    // The server logs every line it handles, which would swamp the timings.
+    if (verbose || type==QtCriticalMsg || type==QtFatalMsg) {
+        fprintf(stderr,"%s\n",qPrintable(message));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    // Keep away from the console's own settings.
+    QCoreApplication::setOrganizationName("Rooster Productions");
+    QCoreApplication::setOrganizationDomain("ohmyno.co.uk");
+    QCoreApplication::setApplicationName("MCBedrockConsBench");
+    // The player model's icons and the online bar need a GUI application, only made for
+    // --model and --join-storm and off screen.
+    bool guiBenchmark = false;
+    for(int x=1;x<argc;x++) {
+        guiBenchmark = guiBenchmark || QByteArray(argv[x])=="--model" || QByteArray(argv[x])=="--join-storm";
+    }
+    if (guiBenchmark && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM","offscreen");
+    }
+    QScopedPointer<QCoreApplication> a(guiBenchmark ? new QApplication(argc, argv) : new QCoreApplication(argc, argv));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays captured bedrock_server output through the console's output pipeline, "
+                                     "or with --live runs the console against a server folder holding tools/fakeserver.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("captures","Capture files or folders of *.log captures.","[captures...]");
+    QCommandLineOption repeatOption("repeat","Replay each capture <count> times.","count","20");
+    QCommandLineOption chunkOption("chunk","Feed the output in <bytes> sized reads.","bytes","65536");
+    QCommandLineOption verboseOption("verbose","Show debug output from the server.");
+    QCommandLineOption liveOption("live","Start, back up, storm and restart the server in <folder>.","folder");
+    QCommandLineOption backupsOption("backups","Backups to take with --live.","count","3");
+    QCommandLineOption stormOption("storm","Players joining at once with --live or --join-storm.","players","80");
+    QCommandLineOption joinStormOption("join-storm","Replay a join and leave storm through the player model and online bar.");
+    QCommandLineOption modelOption("model","Time the player model's data() while scrolling a large player list.");
+    QCommandLineOption playersOption("players","Players in the permission list with --model.","count","20000");
+    parser.addOption(repeatOption);
+    parser.addOption(chunkOption);
+    parser.addOption(verboseOption);
+    parser.addOption(liveOption);
+    parser.addOption(backupsOption);
+    parser.addOption(stormOption);
+    parser.addOption(joinStormOption);
+    parser.addOption(modelOption);
+    parser.addOption(playersOption);
+    parser.process(*a);
+
+    verbose = parser.isSet(verboseOption);
+    qInstallMessageHandler(messageHandler);
+
+    if (parser.isSet(liveOption)) {
+        LifecycleBenchmark live(parser.value(liveOption));
+        live.setBackupCount(parser.value(backupsOption).toInt());
+        live.setStormSize(parser.value(stormOption).toInt());
+        return live.run() ? 0 : 1;
+    }
+
+    if (parser.isSet(joinStormOption)) {
+        StormBenchmark storm;
+        storm.setStormSize(parser.value(stormOption).toInt());
+        return storm.run() ? 0 : 1;
+    }
+
+    if (parser.isSet(modelOption)) {
+        ModelBenchmark model;
+        model.setPlayerCount(parser.value(playersOption).toInt());
+        return model.run() ? 0 : 1;
+    }
+
+    QStringList captures;
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) {
+        args << MCBC_CAPTURE_DIR;
+    }
+    for(int x=0;x<args.size();x++) {
+        QDir dir(args[x]);
+        if (dir.exists()) {
+            QStringList logs = dir.entryList(QStringList() << "*.log",QDir::Files,QDir::Name);
+            for(int y=0;y<logs.size();y++) {
+                captures << dir.filePath(logs[y]);
+            }
+        } else {
+            captures << args[x];
+        }
+    }
+
+    ReplayBenchmark benchmark;
+    benchmark.setRepeat(parser.value(repeatOption).toInt());
+    benchmark.setChunkSize(parser.value(chunkOption).toInt());
+
+    bool passed = !captures.isEmpty();
+    for(int x=0;x<captures.size();x++) {
+        passed = benchmark.run(captures[x]) && passed;
+    }
+    return passed ? 0 : 1;
+}
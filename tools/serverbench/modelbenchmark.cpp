@@ -0,0 +1,107 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "modelbenchmark.h"
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QAbstractItemModel>
+#include <server/bedrockserver.h>
+
+#define MODEL_VISIBLE_ROWS 40
+#define MODEL_ONLINE_PLAYERS 50
+
+quint64 allocationCount(); // See main.cpp
+
+ModelBenchmark::ModelBenchmark(QObject *parent) : QObject(parent),playerCount(20000),frameCount(600)
+{
+}
+
+void ModelBenchmark::setPlayerCount(int count)
+{
+    this->playerCount = (count < 1) ? 1 : count;
+}
+
+void ModelBenchmark::setFrameCount(int count)
+{
+    this->frameCount = (count < 1) ? 1 : count;
+}
+
+bool ModelBenchmark::run()
+{
+    QTextStream out(stdout);
+    BedrockServer server;
+    QAbstractItemModel *model = server.getServerModel();
+
+    QStringList ops;
+    QStringList members;
+    QStringList visitors;
+    for(int x=0;x<this->playerCount;x++) {
+        QString xuid = QString::number(2535400000000000LL+x);
+        (x%100==0 ? ops : x%10<7 ? members : visitors).append(xuid);
+    }
+    QElapsedTimer timer;
+    timer.start();
+    emit server.serverPermissionList(ops,members,visitors);
+    qint64 loadNs = timer.nsecsElapsed();
+    for(int x=0;x<MODEL_ONLINE_PLAYERS;x++) {
+        emit server.playerConnected(QString("Player%1").arg(x),members.at(x));
+    }
+    timer.restart();
+    emit server.serverPermissionList(ops,members,visitors);
+    qint64 unchangedNs = timer.nsecsElapsed();
+
+    // The roles QStyledItemDelegate asks for when painting one row.
+    const int roles[] = { Qt::DisplayRole,Qt::DecorationRole,Qt::FontRole,Qt::TextAlignmentRole,
+                          Qt::ForegroundRole,Qt::BackgroundRole,Qt::CheckStateRole,Qt::SizeHintRole };
+    QModelIndex branch = model->index(1,0); // Members, the largest
+    while (model->canFetchMore(branch)) {
+        model->fetchMore(branch); // As a view scrolled all the way down would
+    }
+    int rows = model->rowCount(branch);
+    quint64 calls = 0;
+    qint64 worstFrameNs = 0;
+    quint64 allocationsBefore = allocationCount();
+    timer.restart();
+    for(int frame=0;frame<this->frameCount;frame++) {
+        QElapsedTimer frameTimer;
+        frameTimer.start();
+        // Scroll a few rows a frame, as a flick through the list would.
+        int top = (frame*7) % qMax(1,rows-MODEL_VISIBLE_ROWS);
+        for(int root=0;root<model->rowCount();root++) {
+            QModelIndex rootIndex = model->index(root,0);
+            for(int role : roles) {
+                model->data(rootIndex,role);
+                calls++;
+            }
+        }
+        for(int row=top;row<top+MODEL_VISIBLE_ROWS && row<rows;row++) {
+            QModelIndex index = model->index(row,0,branch);
+            for(int role : roles) {
+                model->data(index,role);
+                calls++;
+            }
+        }
+        worstFrameNs = qMax(worstFrameNs,frameTimer.nsecsElapsed());
+    }
+    qint64 totalNs = timer.nsecsElapsed();
+    quint64 allocations = allocationCount() - allocationsBefore;
+
+    out << "Player model: " << this->playerCount << " players, " << this->frameCount << " frames of " << MODEL_VISIBLE_ROWS << " rows" << Qt::endl;
+    out << "  first permission list:  " << QString::number(loadNs/1e6,'f',2) << " ms" << Qt::endl;
+    out << "  unchanged list:         " << QString::number(unchangedNs/1e6,'f',2) << " ms" << Qt::endl;
+    out << "  data() calls/frame:     " << calls/this->frameCount << Qt::endl;
+    out << "  data():                 " << QString::number((double)totalNs/calls,'f',0) << " ns/call" << Qt::endl;
+    out << "  frame:                  " << QString::number(totalNs/1e3/this->frameCount,'f',1) << " us average, "
+                                        << QString::number(worstFrameNs/1e3,'f',1) << " us worst" << Qt::endl;
+    out << "  allocations/frame:      " << QString::number((double)allocations/this->frameCount,'f',1) << Qt::endl;
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef MODELBENCHMARK_H
+#define MODELBENCHMARK_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+
+// Fills the player model with a large permission list and scrolls through it the way
+// the tree view does, asking each visible row for the roles a delegate paints with, and
+// reports the cost of data() per call and per frame.
+class ModelBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ModelBenchmark(QObject *parent = nullptr);
+
+    void setPlayerCount(int count);
+    void setFrameCount(int count);
+    bool run(); // Prints a report
+
+private:
+    int playerCount;
+    int frameCount;
+};
+
+#endif // MODELBENCHMARK_H
@@ -0,0 +1,131 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "replaybenchmark.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+ReplayBenchmark::ReplayBenchmark(QObject *parent) : QObject(parent),repeat(1),chunkSize(65536)
+{
+}
+
+void ReplayBenchmark::setRepeat(int count)
+{
+    this->repeat = (count < 1) ? 1 : count;
+}
+
+void ReplayBenchmark::setChunkSize(int bytes)
+{
+    this->chunkSize = (bytes < 1) ? 1 : bytes;
+}
+
+bool ReplayBenchmark::run(QString captureFile)
+{
+    QTextStream out(stdout);
+    QFile capture(captureFile);
+
+    if (!capture.open(QIODevice::ReadOnly)) {
+        out << "Can't open capture: " << captureFile << Qt::endl;
+        return false;
+    }
+
+    // The server ends lines with \r\n, captures may have lost the \r along the way.
+    QMap<QString,quint64> expected;
+    QByteArray data;
+    while (!capture.atEnd()) {
+        QByteArray line = capture.readLine();
+        while (line.endsWith('\n') || line.endsWith('\r')) {
+            line.chop(1);
+        }
+        if (line.startsWith("#!expect ")) {
+            QList<QByteArray> bits = line.split(' ');
+            if (bits.size()==3) {
+                expected.insert(QString(bits[1]),bits[2].toULongLong());
+            }
+            continue;
+        }
+        data.append(line);
+        data.append("\r\n");
+    }
+    capture.close();
+
+    this->events.clear();
+    BedrockServer::PipelineStats totals;
+    qint64 wallNs = 0;
+    quint64 allocations = 0;
+
+    for(int x=0;x<this->repeat;x++) {
+        // Fresh server each time so state from the last run doesn't change the events.
+        BedrockServer *server = new BedrockServer();
+        countEvents(server);
+
+        QElapsedTimer timer;
+        quint64 allocationsBefore = allocationCount();
+        timer.start();
+        for(int offset=0;offset<data.size();offset+=this->chunkSize) {
+            server->processServerOutput(data.mid(offset,this->chunkSize));
+        }
+        wallNs += timer.nsecsElapsed();
+        allocations += allocationCount() - allocationsBefore;
+
+        BedrockServer::PipelineStats stats = server->pipelineStats();
+        totals.lines += stats.lines;
+        totals.outputNs += stats.outputNs;
+        totals.eventsNs += stats.eventsNs;
+        totals.responseNs += stats.responseNs;
+        delete server;
+    }
+
+    double lines = (totals.lines > 0) ? totals.lines : 1;
+    out << QFileInfo(captureFile).fileName() << ": " << totals.lines << " lines, " << this->repeat << " run(s)" << Qt::endl;
+    out << "  lines/sec:              " << qRound64(totals.lines / (wallNs / 1e9)) << Qt::endl;
+    out << "  allocations/line:       " << QString::number(allocations / lines,'f',2) << Qt::endl;
+    out << "  handleServerOutput:     " << QString::number(totals.outputNs / lines,'f',0) << " ns/line" << Qt::endl;
+    out << "  parseOutputForEvents:   " << QString::number(totals.eventsNs / lines,'f',0) << " ns/line" << Qt::endl;
+    out << "  response parsing:       " << QString::number(totals.responseNs / lines,'f',0) << " ns/line" << Qt::endl;
+
+    bool passed = true;
+    for(auto i=expected.constKeyValueBegin();i!=expected.constKeyValueEnd();i++) {
+        quint64 want = (*i).second * this->repeat;
+        quint64 got = this->events.value((*i).first);
+        bool ok = (want==got);
+        passed = passed && ok;
+        out << "  " << (ok ? "PASS " : "FAIL ") << (*i).first << ": expected " << want << ", got " << got << Qt::endl;
+    }
+    return passed;
+}
+
+void ReplayBenchmark::countEvents(BedrockServer *server)
+{
+    connect(server,&BedrockServer::serverStateChanged,this,[=](BedrockServer::ServerState state) {
+        if (state==BedrockServer::ServerRunning) {
+            this->events["serverStarted"]++;
+        }
+    });
+    connect(server,&BedrockServer::serverOutput,this,[=](BedrockServer::OutputType, QString) { this->events["outputLines"]++; });
+    connect(server,&BedrockServer::playerConnected,this,[=](QString, QString) { this->events["playerConnected"]++; });
+    connect(server,&BedrockServer::playerDisconnected,this,[=](QString, QString) { this->events["playerDisconnected"]++; });
+    connect(server,&BedrockServer::backupStarting,this,[=]() { this->events["backupStarting"]++; });
+    connect(server,&BedrockServer::backupInProgres,this,[=]() { this->events["backupInProgres"]++; });
+    connect(server,&BedrockServer::backupSavingData,this,[=]() { this->events["backupSavingData"]++; });
+    connect(server,&BedrockServer::backupFinishedOnServer,this,[=]() { this->events["backupFinishedOnServer"]++; });
+    connect(server,&BedrockServer::serverPermissionList,this,[=](QStringList ops, QStringList members, QStringList visitors) {
+        this->events["permissionList"]++;
+        this->events["permissionEntries"] += ops.size() + members.size() + visitors.size();
+    });
+    connect(server,&BedrockServer::serverWhitelist,this,[=](QStringList members) {
+        this->events["whitelist"]++;
+        this->events["whitelistEntries"] += members.size();
+    });
+}
@@ -0,0 +1,43 @@
+#ifndef REPLAYBENCHMARK_H
+#define REPLAYBENCHMARK_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+#include <QMap>
+#include <server/bedrockserver.h>
+
+quint64 allocationCount(); // Heap allocations made by the process so far, see main.cpp
+
+// Replays a captured bedrock_server stdout log through BedrockServer's output pipeline as
+// fast as possible. Lines starting '#!expect <event> <count>' in the capture are not fed to
+// the server, they give the number of each event the replay should produce.
+class ReplayBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ReplayBenchmark(QObject *parent = nullptr);
+
+    void setRepeat(int count);
+    void setChunkSize(int bytes);
+    bool run(QString captureFile); // Prints a report, false if the capture can't be read or an expectation fails.
+
+private:
+    int repeat;
+    int chunkSize;
+    QMap<QString,quint64> events;
+
+    void countEvents(BedrockServer *server);
+};
+
+#endif // REPLAYBENCHMARK_H
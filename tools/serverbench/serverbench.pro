@@ -0,0 +1,34 @@
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = serverbench
+
+# Adds per stage timings to BedrockServer's output pipeline.
+DEFINES += MCBC_PIPELINE_STATS
+DEFINES += MCBC_CAPTURE_DIR=\\\"$$PWD/captures\\\"
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    lifecyclebenchmark.cpp \
+    main.cpp \
+    modelbenchmark.cpp \
+    replaybenchmark.cpp \
+    stormbenchmark.cpp \
+    ../../src/widgets/onlineplayerwidget.cpp \
+    $$files(../../src/server/*.cpp)
+
+HEADERS += \
+    lifecyclebenchmark.h \
+    modelbenchmark.h \
+    replaybenchmark.h \
+    stormbenchmark.h \
+    ../../src/widgets/onlineplayerwidget.h \
+    $$files(../../src/server/*.h)
+
+DISTFILES += \
+    $$files(captures/*.log)
@@ -0,0 +1,86 @@
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include "stormbenchmark.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QAbstractItemModel>
+#include <server/bedrockserver.h>
+#include <widgets/onlineplayerwidget.h>
+
+StormBenchmark::StormBenchmark(QObject *parent) : QObject(parent),stormSize(80)
+{
+}
+
+void StormBenchmark::setStormSize(int players)
+{
+    this->stormSize = (players < 1) ? 1 : players;
+}
+
+bool StormBenchmark::run()
+{
+    QTextStream out(stdout);
+    out << "Player storm: " << this->stormSize << " players join then leave" << Qt::endl;
+    const char *labels[] = { "  turn per player:", "  one read:       " };
+    for(int x=0;x<2;x++) {
+        Result result = runStorm(x==0);
+        out << labels[x] << QString::number(result.ns/1e6,'f',2).rightJustified(9) << " ms, "
+            << result.rowInserts << " row inserts, " << result.rowRemoves << " row removes, "
+            << result.statusLines << " status lines, " << result.widgetUpdates << " online bar updates" << Qt::endl;
+    }
+    return true;
+}
+
+StormBenchmark::Result StormBenchmark::runStorm(bool turnPerPlayer)
+{
+    Result result;
+    BedrockServer server;
+    QAbstractItemModel *model = server.getServerModel();
+    OnlinePlayerWidget bar;
+    bar.resize(400,24);
+    bar.setServer(&server);
+    bar.show();
+    QCoreApplication::processEvents();
+
+    connect(model,&QAbstractItemModel::rowsInserted,this,[&]() { result.rowInserts++; });
+    connect(model,&QAbstractItemModel::rowsRemoved,this,[&]() { result.rowRemoves++; });
+    connect(&server,&BedrockServer::serverStatusLine,this,[&]() { result.statusLines++; });
+    connect(&server,&BedrockServer::onlinePlayersChanged,this,[&]() { result.widgetUpdates++; });
+
+    QList<QByteArray> lines;
+    for(int x=0;x<this->stormSize;x++) {
+        lines.append(QString("[2026-01-01 12:00:00:000 INFO] Player connected: Storm%1, xuid: %2\n").arg(x).arg(2535500000000000LL+x).toUtf8());
+    }
+    for(int x=0;x<this->stormSize;x++) {
+        lines.append(QString("[2026-01-01 12:05:00:000 INFO] Player disconnected: Storm%1, xuid: %2\n").arg(x).arg(2535500000000000LL+x).toUtf8());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (turnPerPlayer) {
+        for(int x=0;x<lines.size();x++) {
+            server.processServerOutput(lines.at(x));
+            QCoreApplication::processEvents();
+        }
+    } else {
+        // Joins in one read, then leaves in another, as a restart and a stop would deliver them.
+        server.processServerOutput(lines.mid(0,this->stormSize).join());
+        QCoreApplication::processEvents();
+        server.processServerOutput(lines.mid(this->stormSize).join());
+        QCoreApplication::processEvents();
+    }
+    result.ns = timer.nsecsElapsed();
+    disconnect(model,nullptr,this,nullptr);
+    disconnect(&server,nullptr,this,nullptr);
+    return result;
+}
@@ -0,0 +1,46 @@
+#ifndef STORMBENCHMARK_H
+#define STORMBENCHMARK_H
+
+/***
+ *
+ * This file is part of Minecraft Bedrock Server Console software.
+ *
+ * It is licenced under the GNU GPL Version 3.
+ *
+ * A copy of this can be found in the LICENCE file
+ *
+ * (c) Ian Clark
+ *
+ **
+*/
+#include <QObject>
+
+// Replays a join and leave storm through the output pipeline, the player model and the
+// online bar. Once with each player in its own event loop turn, which costs what every
+// event did before player events were batched, and once with the whole storm arriving in
+// one read as it does after a restart.
+class StormBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StormBenchmark(QObject *parent = nullptr);
+
+    void setStormSize(int players);
+    bool run(); // Prints a report
+
+private:
+    class Result {
+    public:
+        qint64 ns = 0;
+        int rowInserts = 0;
+        int rowRemoves = 0;
+        int statusLines = 0;
+        int widgetUpdates = 0;
+    };
+
+    int stormSize;
+
+    Result runStorm(bool turnPerPlayer);
+};
+
+#endif // STORMBENCHMARK_H